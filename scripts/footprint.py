@@ -0,0 +1,162 @@
+"""
+Reports flash/RAM footprint of a firmware build and, optionally, the boot
+time measured on a device.
+
+Boot time is taken from the FSM log line "decision at <N> us", printed on
+every boot. It is kernel uptime, so it starts after MCUboot and its image
+validation; see the README for measuring from reset. It is read from a captured log (--boot-log) or a serial port
+(--serial, or the FOOTPRINT_SERIAL environment variable; needs pyserial).
+Builds without a console (the one-shot profile) are timed from the server
+side instead: a udp_server.py log passed as --boot-log contributes the boot
+stage of each alert's latency record.
+
+Idle current is the average of a power profiler capture (--current-csv, a
+PPK2 "Timestamp(ms),Current(uA)" export) taken while the device monitors.
+"""
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+RAM_BASE = 0x20000000
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+BOOT_RE = re.compile(r'decision at (\d+) us')
+# udp_server.py latency line: "Latency    : ... (boot <ms>, attach ..."
+SERVER_BOOT_RE = re.compile(r'Latency\s*:.*\(boot (\d+),')
+
+
+def elf_sections(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] != 1:
+        raise ValueError(f"{path}: not a 32-bit ELF")
+    e_shoff, = struct.unpack_from('<I', data, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+
+    headers = []
+    for i in range(e_shnum):
+        off = e_shoff + i * e_shentsize
+        name, stype, flags, addr, _, size = struct.unpack_from('<IIIIII', data, off)
+        headers.append((name, stype, flags, addr, size))
+
+    strtab_off = struct.unpack_from('<I', data, e_shoff + e_shstrndx * e_shentsize + 16)[0]
+    for name, stype, flags, addr, size in headers:
+        end = data.index(b'\0', strtab_off + name)
+        yield data[strtab_off + name:end].decode(), stype, flags, addr, size
+
+
+def footprint(elf):
+    flash = ram = 0
+    for _, stype, flags, addr, size in elf_sections(elf):
+        if not (flags & SHF_ALLOC) or size == 0:
+            continue
+        if addr >= RAM_BASE:
+            ram += size
+            # Initialised data is also stored in flash
+            if stype != SHT_NOBITS and (flags & SHF_WRITE):
+                flash += size
+        else:
+            flash += size
+    return flash, ram
+
+
+def variant(config_path):
+    selected = []
+    with open(config_path) as f:
+        for line in f:
+            m = re.match(r'CONFIG_(SEAL_(?:UPLINK|PROFILE|MONITOR)_[A-Z_]+)=y', line)
+            if m:
+                selected.append(m.group(1))
+    return ','.join(selected) or 'default'
+
+
+def boot_times(lines):
+    times = []
+    for line in lines:
+        m = BOOT_RE.search(line)
+        if m:
+            times.append(int(m.group(1)))
+            continue
+        m = SERVER_BOOT_RE.search(line)
+        if m:
+            times.append(int(m.group(1)) * 1000)
+    return times
+
+
+def idle_current_ua(csv_path):
+    import csv
+    with open(csv_path, newline='') as f:
+        reader = csv.reader(f)
+        header = next(reader)
+        col = next(i for i, name in enumerate(header) if 'current' in name.lower())
+        samples = [float(row[col]) for row in reader if len(row) > col and row[col]]
+    if not samples:
+        raise ValueError(f"{csv_path}: no current samples")
+    return sum(samples) / len(samples), len(samples)
+
+
+def read_serial(port, count, timeout_s=120):
+    import serial  # pyserial
+    times = []
+    with serial.Serial(port, 115200, timeout=timeout_s) as ser:
+        print(f"Reset the device {count} time(s) to capture boot times...", file=sys.stderr)
+        while len(times) < count:
+            line = ser.readline().decode(errors='replace')
+            if not line:
+                break
+            times += boot_times([line])
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Firmware footprint and boot-time report')
+    parser.add_argument('--elf', required=True)
+    parser.add_argument('--config', required=True, help='Build .config, used to label the variant')
+    parser.add_argument('--boot-log', default=os.environ.get('FOOTPRINT_BOOT_LOG'),
+                        help='Captured console or udp_server.py log containing boot lines')
+    parser.add_argument('--serial', default=os.environ.get('FOOTPRINT_SERIAL'))
+    parser.add_argument('--boots', type=int, default=5, help='Boots to capture over serial')
+    parser.add_argument('--current-csv', default=os.environ.get('FOOTPRINT_CURRENT_CSV'),
+                        help='Power profiler export captured while monitoring')
+    parser.add_argument('--json', action='store_true')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.elf):
+        print(f"Error: {args.elf} not found; build the image first", file=sys.stderr)
+        return 1
+
+    flash, ram = footprint(args.elf)
+    report = {'variant': variant(args.config), 'flash_bytes': flash, 'ram_bytes': ram}
+
+    times = []
+    if args.boot_log and os.path.exists(args.boot_log):
+        with open(args.boot_log, errors='replace') as f:
+            times = boot_times(f)
+    elif args.serial:
+        times = read_serial(args.serial, args.boots)
+    if times:
+        report['boot_us_avg'] = sum(times) // len(times)
+        report['boot_us_min'] = min(times)
+        report['boots'] = len(times)
+    if args.current_csv and os.path.exists(args.current_csv):
+        report['idle_ua_avg'], report['idle_samples'] = idle_current_ua(args.current_csv)
+
+    if args.json:
+        print(json.dumps(report))
+    else:
+        line = f"{report['variant']:<40} flash {flash:>8} B   ram {ram:>8} B"
+        if times:
+            line += f"   boot {report['boot_us_avg']} us avg over {len(times)}"
+        if 'idle_ua_avg' in report:
+            line += f"   idle {report['idle_ua_avg']:.1f} uA"
+        print(line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
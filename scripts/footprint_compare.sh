@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# Builds every uplink variant and deployment profile and reports flash/RAM footprint side by side.
+# Set FOOTPRINT_SERIAL=/dev/ttyACM0 to also flash each image and capture boot times.
+# Set FOOTPRINT_MEASURE_DIR to a directory of captures named after the variant to
+# add them instead: <variant>.log (console or udp_server.py log, for boot times)
+# and <variant>.csv (power profiler export taken while monitoring, for idle current).
+#
+# usage: scripts/footprint_compare.sh [board]
+#
+set -e
+
+BOARD=${1:-nrf9160dk/nrf9160/ns}
+APP_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+build_variant() {
+    name=$1
+    shift
+    dir="$APP_DIR/build_footprint/$name"
+    west build -p auto -b "$BOARD" -d "$dir" "$APP_DIR" -- "$@" > "$dir.log" 2>&1 || {
+        echo "$name: build failed, see $dir.log" >&2
+        exit 1
+    }
+    if [ -n "$FOOTPRINT_SERIAL" ]; then
+        west flash -d "$dir" >> "$dir.log" 2>&1
+    fi
+    if [ -n "$FOOTPRINT_MEASURE_DIR" ]; then
+        export FOOTPRINT_BOOT_LOG="$FOOTPRINT_MEASURE_DIR/$name.log"
+        export FOOTPRINT_CURRENT_CSV="$FOOTPRINT_MEASURE_DIR/$name.csv"
+    fi
+    # Sysbuild does not forward app targets; run it in the app image's own build directory
+    app_dir="$dir"
+    if [ -f "$dir/domains.yaml" ]; then
+        app_dir="$dir/$(sed -n 's/^default: *//p' "$dir/domains.yaml")"
+    fi
+    report=$(cmake --build "$app_dir" -t footprint 2>> "$dir.log") || {
+        echo "$name: footprint target failed, see $dir.log" >&2
+        exit 1
+    }
+    echo "$report" | grep -E "flash .* ram" || {
+        echo "$name: no footprint line in the report" >&2
+        exit 1
+    }
+}
+
+mkdir -p "$APP_DIR/build_footprint"
+build_variant posix
+build_variant lean -DEXTRA_CONF_FILE=overlay-lean-uplink.conf
+build_variant oneshot-ulp -DEXTRA_CONF_FILE=overlay-profile-oneshot-ulp.conf
+build_variant multi-event -DEXTRA_CONF_FILE=overlay-profile-multi-event.conf
+build_variant warm -DEXTRA_CONF_FILE=overlay-profile-warm.conf
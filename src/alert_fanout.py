@@ -0,0 +1,328 @@
+import http.client
+import json
+import os
+import queue
+import random
+import socket
+import sys
+import threading
+import time
+from urllib.parse import urlparse
+
+from latency_hist import LatencyHistogram
+
+
+class FileSink:
+    """
+    Appends events as JSON lines; the stand-in for log shippers.
+    """
+
+    def __init__(self, path):
+        self.name = f"file:{path}"
+        self.path = path
+
+    def send_batch(self, events):
+        with open(self.path, 'a') as f:
+            f.write(''.join(json.dumps(e) + '\n' for e in events))
+            f.flush()
+            os.fsync(f.fileno())
+
+
+class WebhookSink:
+    """
+    POSTs each batch as a JSON array; any 2xx acknowledges the whole batch.
+    The connection is kept alive, a fresh TCP (and TLS) handshake per batch
+    costs more than the request itself.
+    """
+
+    def __init__(self, url, timeout=2.0):
+        u = urlparse(url)
+        self.name = url
+        self.cls = http.client.HTTPSConnection if u.scheme == 'https' else http.client.HTTPConnection
+        self.netloc = u.netloc
+        self.path = u.path or '/'
+        self.timeout = timeout
+        self.conn = None
+
+    def send_batch(self, events):
+        body = json.dumps(events).encode()
+        try:
+            if self.conn is None:
+                self.conn = self.cls(self.netloc, timeout=self.timeout)
+            self.conn.request('POST', self.path, body, {'Content-Type': 'application/json'})
+            resp = self.conn.getresponse()
+            resp.read()
+            if resp.will_close:
+                self.conn.close()
+                self.conn = None
+        except Exception:
+            if self.conn is not None:
+                self.conn.close()
+            self.conn = None
+            raise
+        if resp.status // 100 != 2:
+            raise IOError(f"HTTP {resp.status}")
+
+
+class NatsSink:
+    """
+    Publishes to a NATS subject over the plain text protocol. A PING after
+    the batch is answered with PONG only once the server has processed
+    every PUB before it, which is the acknowledgement for the batch.
+    """
+
+    def __init__(self, url, timeout=2.0):
+        u = urlparse(url)
+        self.name = url
+        self.addr = (u.hostname or 'localhost', u.port or 4222)
+        self.subject = u.path.lstrip('/') or 'seal.alerts'
+        self.timeout = timeout
+        self.sock = None
+        self.rx = b''
+
+    def _connect(self):
+        self.sock = socket.create_connection(self.addr, timeout=self.timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.rx = b''
+        self._read_line()  # INFO
+        self.sock.sendall(b'CONNECT {"verbose":false,"pedantic":false}\r\n')
+
+    def _read_line(self):
+        while b'\r\n' not in self.rx:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("NATS connection closed")
+            self.rx += chunk
+        line, self.rx = self.rx.split(b'\r\n', 1)
+        return line
+
+    def send_batch(self, events):
+        try:
+            if self.sock is None:
+                self._connect()
+            out = bytearray()
+            for e in events:
+                payload = json.dumps(e).encode()
+                out += f"PUB {self.subject} {len(payload)}\r\n".encode() + payload + b'\r\n'
+            out += b'PING\r\n'
+            self.sock.sendall(out)
+            while True:
+                line = self._read_line()
+                if line == b'PONG':
+                    return
+                if line.startswith(b'-ERR'):
+                    raise IOError(line.decode(errors='replace'))
+                if line == b'PING':
+                    self.sock.sendall(b'PONG\r\n')
+        except Exception:
+            if self.sock is not None:
+                self.sock.close()
+            self.sock = None
+            raise
+
+
+def make_sink(spec):
+    """
+    file:<path>, http(s)://..., nats://host:port/subject
+    """
+    if spec.startswith('file:'):
+        return FileSink(spec[5:])
+    if spec.startswith(('http://', 'https://')):
+        return WebhookSink(spec)
+    if spec.startswith('nats://'):
+        return NatsSink(spec)
+    raise ValueError(f"Unknown sink '{spec}'")
+
+
+class Journal:
+    """
+    Append-only overflow spool for one sink. Events land here when the sink's
+    queue is full or a batch could not be delivered; the worker replays them
+    once the sink keeps up. Every append is fsynced before it returns, so a
+    spilled event survives a crash and delivery is at-least-once.
+    """
+
+    def __init__(self, path):
+        self.path = path
+        self.lock = threading.Lock()
+        self.offset = 0
+        self.f = open(path, 'a+')
+
+    def append(self, events):
+        with self.lock:
+            self.f.write(''.join(json.dumps(e) + '\n' for e in events))
+            self.f.flush()
+            os.fsync(self.f.fileno())
+
+    def flush(self):
+        with self.lock:
+            self.f.flush()
+
+    def read(self, max_events):
+        with self.lock:
+            self.f.flush()
+            self.f.seek(self.offset)
+            lines = []
+            while len(lines) < max_events:
+                line = self.f.readline()
+                if not line.endswith('\n'):
+                    break
+                lines.append(line)
+            end = self.f.tell()
+            self.f.seek(0, os.SEEK_END)
+        # Parse outside the lock; publish() may be waiting to spill
+        return [json.loads(line) for line in lines], end
+
+    def commit(self, end):
+        with self.lock:
+            self.offset = end
+            # Fully replayed: start over instead of growing forever
+            if self.offset >= self.f.seek(0, os.SEEK_END):
+                self.f.truncate(0)
+                self.offset = 0
+
+    def pending(self):
+        with self.lock:
+            return self.f.seek(0, os.SEEK_END) > self.offset
+
+
+class SinkWorker:
+    """
+    Delivers to one sink from a bounded queue, in micro-batches, retrying
+    with capped exponential backoff. Never blocks the publisher.
+    """
+
+    def __init__(self, sink, journal_dir, queue_size=4096, batch_max=256, linger_ms=0,
+                 backoff_base_ms=50, backoff_max_ms=5000):
+        self.sink = sink
+        self.q = queue.Queue(maxsize=queue_size)
+        self.batch_max = batch_max
+        self.linger = linger_ms / 1000.0
+        self.backoff_base = backoff_base_ms / 1000.0
+        self.backoff_max = backoff_max_ms / 1000.0
+        safe = ''.join(c if c.isalnum() else '_' for c in sink.name)
+        os.makedirs(journal_dir, exist_ok=True)
+        self.journal = Journal(os.path.join(journal_dir, f"{safe}.ndjson"))
+        self.latency_us = LatencyHistogram()
+        self.delivered = 0
+        self.spilled = 0
+        self.retries = 0
+        self.running = True
+        self.stopping = threading.Event()
+        self.thread = threading.Thread(target=self._run, name=f"sink-{safe}", daemon=True)
+
+    def offer(self, event, t_ingest):
+        try:
+            self.q.put_nowait((event, t_ingest))
+        except queue.Full:
+            # Backpressure: spill instead of waiting on a slow consumer
+            self.journal.append([event])
+            self.spilled += 1
+
+    def _take_batch(self):
+        try:
+            batch = [self.q.get(timeout=0.1)]
+        except queue.Empty:
+            return []
+        # Whatever queued up while the previous batch was in flight goes out together, so
+        # batches grow with load without delaying a lone alert; linger_ms trades latency for fewer round trips
+        deadline = time.monotonic() + self.linger
+        while len(batch) < self.batch_max:
+            remaining = deadline - time.monotonic()
+            try:
+                batch.append(self.q.get(timeout=remaining) if remaining > 0 else self.q.get_nowait())
+            except queue.Empty:
+                break
+        return batch
+
+    def _deliver(self, events):
+        attempt = 0
+        while self.running:
+            try:
+                self.sink.send_batch(events)
+                return True
+            except Exception as e:
+                attempt += 1
+                self.retries += 1
+                delay = min(self.backoff_max, self.backoff_base * (2 ** min(attempt, 16)))
+                if attempt == 1:
+                    print(f"  [fanout] {self.sink.name}: {e}, retrying")
+                self.stopping.wait(delay * random.uniform(0.5, 1.0))
+        return False
+
+    def _run(self):
+        while self.running:
+            batch = self._take_batch()
+            if batch:
+                events = [e for e, _ in batch]
+                if self._deliver(events):
+                    now = time.monotonic()
+                    for _, t in batch:
+                        self.latency_us.record((now - t) * 1e6)
+                    self.delivered += len(events)
+                else:
+                    self.journal.append(events)
+                continue
+
+            # Idle: replay spilled events
+            self.journal.flush()
+            if self.journal.pending():
+                events, end = self.journal.read(self.batch_max)
+                if events and self._deliver(events):
+                    self.journal.commit(end)
+                    self.delivered += len(events)
+
+    def stop(self, timeout=2.0):
+        # Whatever is still queued goes to the journal for the next run
+        deadline = time.monotonic() + timeout
+        while not self.q.empty() and time.monotonic() < deadline:
+            time.sleep(0.01)
+        self.running = False
+        self.stopping.set()
+        self.thread.join(timeout)
+        leftover = []
+        while True:
+            try:
+                leftover.append(self.q.get_nowait()[0])
+            except queue.Empty:
+                break
+        if leftover:
+            self.journal.append(leftover)
+        self.journal.flush()
+
+
+class AlertFanout:
+    """
+    Pushes decoded alerts to every configured sink. publish() only enqueues,
+    so UDP reception never waits on a consumer.
+    """
+
+    def __init__(self, sink_specs, journal_dir='fanout_journal', **worker_args):
+        self.workers = [SinkWorker(make_sink(s), journal_dir, **worker_args) for s in sink_specs]
+        self.publish_us = LatencyHistogram()
+        if self.workers:
+            # The default 5 ms GIL hand-off would dominate delivery latency while the UDP loop is busy
+            sys.setswitchinterval(0.0005)
+        for w in self.workers:
+            w.thread.start()
+
+    def publish(self, event):
+        t = time.monotonic()
+        for w in self.workers:
+            w.offer(event, t)
+        self.publish_us.record((time.monotonic() - t) * 1e6)
+
+    def report(self):
+        if not self.workers:
+            return
+        print("\n=== Alert fan-out (us) ===")
+        print(f"  publish: {self.publish_us.summary()}")
+        for w in self.workers:
+            print(f"  {w.sink.name}: delivered {w.delivered}, queued {w.q.qsize()}, "
+                  f"spilled {w.spilled}, retries {w.retries}, "
+                  f"journal {'pending' if w.journal.pending() else 'empty'}")
+            print(f"    ingest-to-ack: {w.latency_us.summary()}")
+
+    def close(self):
+        for w in self.workers:
+            w.stop()
@@ -0,0 +1,294 @@
+#include "config.h"
+#include "storage.h"
+#include "retained.h"
+#include "provision.h"
+#include "watchdog_mgr.h"
+#include "../power/power_mgr.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(config);
+
+/* Compile-time defaults, used until a valid config is stored */
+static const struct seal_config config_defaults = {
+    .blob_version = SEAL_CFG_BLOB_VERSION,
+    .seq = 0,
+    .target_dark_seconds = 120,
+    .dark_threshold = 5,        // 5 counts ~ 0.05 lux
+    .int_threshold = 0x00A0,
+    .tx_retries = 3,
+    .trial = 0,
+    .sock_timeout_s = 60,
+    .retry_delay_s = 60,
+    .wdt_timeout_ms = 180000,   // 3 minutes
+};
+
+/* Resets that count as a failed trial */
+#define CONFIG_TRIAL_FAIL_CAUSES (RESET_WATCHDOG | RESET_CPU_LOCKUP)
+
+static struct seal_config active;
+
+/* Copy of the active config kept across System OFF, so the wake path skips NVS */
+static struct seal_config cache __retained;
+
+/* A downlink staged a config in NVS this boot */
+static bool staged;
+
+static uint32_t config_crc(const struct seal_config *cfg)
+{
+    return crc32_ieee((const uint8_t *)cfg, offsetof(struct seal_config, crc));
+}
+
+static void config_seal(struct seal_config *cfg)
+{
+    cfg->crc = config_crc(cfg);
+}
+
+static int config_validate(const struct seal_config *cfg)
+{
+    if (cfg->blob_version != SEAL_CFG_BLOB_VERSION) {
+        return -EINVAL;
+    }
+    if (cfg->target_dark_seconds < 10 || cfg->target_dark_seconds > 3600) {
+        return -ERANGE;
+    }
+    if (cfg->dark_threshold < 1 || cfg->int_threshold <= cfg->dark_threshold) {
+        return -ERANGE;
+    }
+    if (cfg->tx_retries < 1 || cfg->tx_retries > 10) {
+        return -ERANGE;
+    }
+    if (cfg->sock_timeout_s < 5 || cfg->sock_timeout_s > 300 ||
+        cfg->retry_delay_s < 5 || cfg->retry_delay_s > 600) {
+        return -ERANGE;
+    }
+    /*
+     * Longest stretch without a kick: the last back-off chunk, a DNS lookup,
+     * then connect and send blocking for up to sock_timeout_s each, plus margin.
+     * Longer waits (retry_delay_s, deferral) kick every chunk; warm monitoring
+     * kicks at half the timeout.
+     */
+    uint32_t longest_wait_ms = WATCHDOG_SLEEP_CHUNK_S * 1000U + 2U * CONFIG_SEAL_DNS_TIMEOUT_MS +
+                               2U * cfg->sock_timeout_s * 1000U;
+    if (cfg->wdt_timeout_ms < 30000 || cfg->wdt_timeout_ms > 600000 ||
+        cfg->wdt_timeout_ms < longest_wait_ms + 10000U) {
+        return -ERANGE;
+    }
+    return 0;
+}
+
+static bool config_is_valid(const struct seal_config *cfg)
+{
+    return (cfg->crc == config_crc(cfg)) && (config_validate(cfg) == 0);
+}
+
+static void config_set_active(const struct seal_config *cfg)
+{
+    active = *cfg;
+    cache = *cfg;
+}
+
+static void config_rollback(void)
+{
+    struct seal_config prev;
+    int rc = storage_read(NVS_ID_CONFIG_PREV, &prev, sizeof(prev));
+
+    if (rc != sizeof(prev) || !config_is_valid(&prev)) {
+        LOG_WRN("No valid previous config, reverting to defaults");
+        prev = config_defaults;
+        config_seal(&prev);
+    }
+
+    LOG_WRN("Config seq %u failed its trial, rolling back to seq %u", active.seq, prev.seq);
+    storage_write(NVS_ID_CONFIG, &prev, sizeof(prev));
+    config_set_active(&prev);
+}
+
+void config_init(void)
+{
+    if (config_is_valid(&cache)) {
+        active = cache;
+    } else {
+        struct seal_config stored;
+        int rc = storage_read(NVS_ID_CONFIG, &stored, sizeof(stored));
+
+        if (rc == sizeof(stored) && config_is_valid(&stored)) {
+            config_set_active(&stored);
+        } else {
+            // Never tuned remotely: factory overrides, if any, on top of the defaults
+            uint8_t entries[PROVISION_MAX_CFG * SEAL_CFG_DOWNLINK_ENTRY];
+            int count = provision_get_config(entries, sizeof(entries));
+            struct seal_config def;
+
+            if (config_from_entries(&def, entries, (uint8_t)count) < 0) {
+                def = config_defaults;
+                config_seal(&def);
+            }
+            config_set_active(&def);
+        }
+    }
+
+    if (active.trial && (power_mgr_reset_cause() & CONFIG_TRIAL_FAIL_CAUSES)) {
+        config_rollback();
+    }
+
+    LOG_INF("Config seq %u%s", active.seq, active.trial ? " (trial)" : "");
+}
+
+void config_reload(void)
+{
+    cache.crc = ~cache.crc;
+    config_init();
+}
+
+const struct seal_config *config_get(void)
+{
+    return &active;
+}
+
+static int config_set_key(struct seal_config *cfg, uint8_t key, uint32_t value)
+{
+    switch (key) {
+    case SEAL_CFG_KEY_DARK_SECONDS:
+        cfg->target_dark_seconds = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case SEAL_CFG_KEY_DARK_THRESHOLD:
+        cfg->dark_threshold = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case SEAL_CFG_KEY_INT_THRESHOLD:
+        cfg->int_threshold = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case SEAL_CFG_KEY_TX_RETRIES:
+        cfg->tx_retries = (uint8_t)MIN(value, UINT8_MAX);
+        break;
+    case SEAL_CFG_KEY_SOCK_TIMEOUT:
+        cfg->sock_timeout_s = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case SEAL_CFG_KEY_RETRY_DELAY:
+        cfg->retry_delay_s = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case SEAL_CFG_KEY_WDT_TIMEOUT:
+        cfg->wdt_timeout_ms = value;
+        break;
+    default:
+        return -ENOTSUP;
+    }
+    return 0;
+}
+
+static int config_apply_entries(struct seal_config *cfg, const uint8_t *entries, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *entry = &entries[i * SEAL_CFG_DOWNLINK_ENTRY];
+        int rc = config_set_key(cfg, entry[0], sys_get_le32(&entry[1]));
+        if (rc < 0) {
+            LOG_WRN("Config key %u not supported", entry[0]);
+            return rc;
+        }
+    }
+    return 0;
+}
+
+int config_from_entries(struct seal_config *cfg, const uint8_t *entries, uint8_t count)
+{
+    *cfg = config_defaults;
+
+    int rc = config_apply_entries(cfg, entries, count);
+    if (rc == 0) {
+        rc = config_validate(cfg);
+    }
+    config_seal(cfg);
+    return rc;
+}
+
+int config_apply_downlink(const uint8_t *buf, size_t len)
+{
+    if (len < SEAL_CFG_DOWNLINK_HDR || buf[0] != SEAL_CFG_DOWNLINK_MAGIC ||
+        buf[1] != SEAL_CFG_DOWNLINK_VERSION) {
+        return -EBADMSG;
+    }
+
+    uint16_t seq = sys_get_le16(&buf[2]);
+    uint8_t count = buf[4];
+
+    if (count == 0 || seq == active.seq) {
+        return 1; // Plain acknowledgement
+    }
+    size_t body_len = SEAL_CFG_DOWNLINK_HDR + (size_t)count * SEAL_CFG_DOWNLINK_ENTRY;
+    if (len < body_len + SEAL_CFG_DOWNLINK_TAG) {
+        return -EBADMSG;
+    }
+
+    // Any datagram on the socket is taken as the reply; only the key holder may retune
+    uint8_t alert_seq[4];
+    sys_put_le32(retained_get()->seq_num, alert_seq);
+    int rc = provision_verify_tag(buf, body_len, alert_seq, sizeof(alert_seq), &buf[body_len]);
+    if (rc < 0) {
+        LOG_WRN("Downlink config seq %u not authenticated: %d", seq, rc);
+        return -EACCES;
+    }
+
+    struct seal_config next = active;
+    next.seq = seq;
+    next.trial = 1;
+
+    rc = config_apply_entries(&next, &buf[SEAL_CFG_DOWNLINK_HDR], count);
+    if (rc < 0) {
+        return rc;
+    }
+
+    rc = config_validate(&next);
+    if (rc < 0) {
+        LOG_WRN("Downlink config seq %u rejected: %d", seq, rc);
+        return rc;
+    }
+    config_seal(&next);
+
+    // Keep the current config as the rollback target, unless it is itself unconfirmed
+    if (!active.trial) {
+        rc = storage_write(NVS_ID_CONFIG_PREV, &active, sizeof(active));
+        if (rc < 0) {
+            return rc;
+        }
+    }
+    rc = storage_write(NVS_ID_CONFIG, &next, sizeof(next));
+    if (rc < 0) {
+        return rc;
+    }
+
+    // Next boot reads the staged config from NVS
+    cache.crc = ~cache.crc;
+    staged = true;
+    LOG_INF("Config seq %u staged for next boot", seq);
+    return 0;
+}
+
+bool config_staged(void)
+{
+    return staged;
+}
+
+void config_report_uplink(bool sent, bool replied)
+{
+    if (!active.trial) {
+        return;
+    }
+
+    if (replied) {
+        active.trial = 0;
+        config_seal(&active);
+        storage_write(NVS_ID_CONFIG, &active, sizeof(active));
+        cache = active;
+        LOG_INF("Config seq %u confirmed", active.seq);
+    } else if (!sent) {
+        config_rollback();
+    } else {
+        // The server may never have heard from this config; stay on trial
+        LOG_INF("Config seq %u unanswered, still on trial", active.seq);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef SEAL_CONFIG_H
+#define SEAL_CONFIG_H
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file config.h
+ * @brief Versioned runtime configuration, stored in NVS and tuned remotely.
+ *
+ * The server piggybacks config deltas on its reply to an alert. A delta is
+ * staged in NVS and becomes active at the next boot as a trial. The server's
+ * reply to the next alert confirms it; a watchdog reset, a fault or an alert
+ * that could not be sent rolls it back to the previous config.
+ *
+ * When that next boot happens depends on the profile:
+ *   - multi-event, System OFF monitoring: the next wake from System OFF.
+ *   - multi-event, warm monitoring: the FSM reboots after re-arming, since
+ *     the device would otherwise never boot again (see config_staged()).
+ *   - single alert (standard, one-shot): the device terminates after its
+ *     alert, so it does not report its config seq and takes no deltas.
+ *     Only the provisioning bundle configures it.
+ */
+
+#define SEAL_CFG_BLOB_VERSION 1
+
+struct seal_config {
+    uint16_t blob_version;        // SEAL_CFG_BLOB_VERSION
+    uint16_t seq;                 // Revision assigned by the server
+    uint16_t target_dark_seconds; // Darkness required to arm
+    uint16_t dark_threshold;      // Lux counts below which it is "dark"
+    uint16_t int_threshold;       // VEML6035 high interrupt threshold
+    uint8_t tx_retries;           // Uplink attempts per alert
+    uint8_t trial;                // 1 until confirmed by a successful uplink
+    uint16_t sock_timeout_s;      // Socket send/receive timeout
+    uint16_t retry_delay_s;       // Back-off between uplink attempts
+    uint32_t wdt_timeout_ms;      // Global watchdog timeout
+    uint32_t crc;                 // CRC32 over all preceding fields
+} __packed;
+
+/* Keys used in the downlink delta: [key u8][value u32 LE] */
+enum config_key {
+    SEAL_CFG_KEY_DARK_SECONDS = 1,
+    SEAL_CFG_KEY_DARK_THRESHOLD = 2,
+    SEAL_CFG_KEY_INT_THRESHOLD = 3,
+    SEAL_CFG_KEY_TX_RETRIES = 4,
+    SEAL_CFG_KEY_SOCK_TIMEOUT = 5,
+    SEAL_CFG_KEY_RETRY_DELAY = 6,
+    SEAL_CFG_KEY_WDT_TIMEOUT = 7,
+};
+
+/*
+ * Downlink reply: 'A', version, seq u16 LE, count, then count x (key, value).
+ * A delta (count > 0) ends in a tag: HMAC-SHA256 truncated to 16 bytes, keyed
+ * with the provisioned device key, over the reply followed by the alert
+ * sequence (u32 LE) it answers, so it cannot be replayed on a later alert.
+ */
+#define SEAL_CFG_DOWNLINK_MAGIC   0x41
+#define SEAL_CFG_DOWNLINK_VERSION 2
+#define SEAL_CFG_DOWNLINK_HDR     5
+#define SEAL_CFG_DOWNLINK_ENTRY   5
+#define SEAL_CFG_DOWNLINK_TAG     16
+
+/**
+ * @brief Load the active config: retained RAM copy, then NVS, then the
+ *        provisioned overrides on top of the defaults.
+ *
+ * Rolls back a trial config if this boot follows a watchdog reset or fault.
+ */
+void config_init(void);
+
+/**
+ * @brief Drop the retained copy and load the active config again.
+ *
+ * For after provisioning, which stores overrides once config_init() has run.
+ */
+void config_reload(void);
+
+/**
+ * @brief Build a sealed config from the defaults plus [key u8][value u32 LE] entries.
+ *
+ * Used for the config overrides of the factory provisioning bundle.
+ * @return 0 if the result is valid, negative errno otherwise.
+ */
+int config_from_entries(struct seal_config *cfg, const uint8_t *entries, uint8_t count);
+
+/**
+ * @brief Active configuration.
+ */
+const struct seal_config *config_get(void);
+
+/**
+ * @brief Authenticate, validate and stage a downlink delta as the next trial config.
+ *
+ * @return 0 if staged (applied on next boot), 1 if nothing to do,
+ *         -EACCES if the tag does not verify or the unit has no device key,
+ *         other negative errno if the downlink or resulting config is invalid.
+ */
+int config_apply_downlink(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Whether a downlink staged a config that the next boot will load.
+ */
+bool config_staged(void);
+
+/**
+ * @brief Report the outcome of an uplink to a trial config.
+ *
+ * Only a server reply confirms the trial and only a failed send rolls it
+ * back; a datagram sent without an answer decides nothing.
+ *
+ * @param sent    The alert went out on at least one attempt.
+ * @param replied The server answered it.
+ */
+void config_report_uplink(bool sent, bool replied);
+
+#endif
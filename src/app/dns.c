@@ -0,0 +1,154 @@
+#include "dns.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/random/random.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(dns);
+
+#define DNS_HDR_SIZE     12
+#define DNS_FLAG_QR      0x8000
+#define DNS_FLAG_RD      0x0100
+#define DNS_RCODE_MASK   0x000F
+#define DNS_RCODE_NXDOMAIN 3
+#define DNS_TYPE_A       1
+#define DNS_CLASS_IN     1
+
+/* Plenty for a handful of A records; a truncated reply still yields the first ones */
+#define DNS_REPLY_MAX    256
+
+// Header, QNAME as length-prefixed labels, QTYPE A, QCLASS IN
+static int dns_encode_query(uint16_t id, const char *name, uint8_t *out, size_t cap)
+{
+    size_t name_len = strlen(name);
+
+    if (name_len == 0 || name_len > DNS_NAME_MAX || cap < DNS_HDR_SIZE + name_len + 6) {
+        return -EINVAL;
+    }
+
+    memset(out, 0, DNS_HDR_SIZE);
+    sys_put_be16(id, &out[0]);
+    sys_put_be16(DNS_FLAG_RD, &out[2]);
+    sys_put_be16(1, &out[4]);
+
+    size_t pos = DNS_HDR_SIZE;
+    const char *label = name;
+    while (*label != '\0') {
+        const char *dot = strchr(label, '.');
+        size_t len = (dot != NULL) ? (size_t)(dot - label) : strlen(label);
+
+        if (len == 0 || len > 63) {
+            return -EINVAL;
+        }
+        out[pos++] = (uint8_t)len;
+        memcpy(&out[pos], label, len);
+        pos += len;
+        label += len + ((dot != NULL) ? 1 : 0);
+    }
+    out[pos++] = 0;
+    sys_put_be16(DNS_TYPE_A, &out[pos]);
+    sys_put_be16(DNS_CLASS_IN, &out[pos + 2]);
+    return (int)(pos + 4);
+}
+
+// Offset just past the name at @p off, following at most the first compression pointer
+static int dns_skip_name(const uint8_t *msg, size_t len, size_t off)
+{
+    while (off < len) {
+        uint8_t l = msg[off];
+
+        if (l == 0) {
+            return (int)(off + 1);
+        }
+        if ((l & 0xC0) == 0xC0) {
+            return (off + 2 <= len) ? (int)(off + 2) : -EBADMSG;
+        }
+        if (l & 0xC0) {
+            return -EBADMSG;
+        }
+        off += 1 + l;
+    }
+    return -EBADMSG;
+}
+
+static int dns_parse_reply(uint16_t id, const uint8_t *msg, size_t len, struct dns_result *res)
+{
+    if (len < DNS_HDR_SIZE || sys_get_be16(&msg[0]) != id) {
+        return -EBADMSG;
+    }
+
+    uint16_t flags = sys_get_be16(&msg[2]);
+    if (!(flags & DNS_FLAG_QR)) {
+        return -EBADMSG;
+    }
+    if ((flags & DNS_RCODE_MASK) == DNS_RCODE_NXDOMAIN) {
+        return -ENOENT;
+    }
+    if ((flags & DNS_RCODE_MASK) != 0) {
+        return -EIO;
+    }
+
+    uint16_t qdcount = sys_get_be16(&msg[4]);
+    uint16_t ancount = sys_get_be16(&msg[6]);
+    int off = DNS_HDR_SIZE;
+
+    for (uint16_t i = 0; i < qdcount; i++) {
+        off = dns_skip_name(msg, len, off);
+        if (off < 0 || (size_t)off + 4 > len) {
+            return -EBADMSG;
+        }
+        off += 4;
+    }
+
+    res->count = 0;
+    res->ttl_s = UINT32_MAX;
+
+    // CNAMEs come first in the answer section; the A records after them are the target's
+    for (uint16_t i = 0; i < ancount && res->count < DNS_MAX_ADDRS; i++) {
+        off = dns_skip_name(msg, len, off);
+        if (off < 0 || (size_t)off + 10 > len) {
+            break; // Truncated: keep what was complete
+        }
+        uint16_t type = sys_get_be16(&msg[off]);
+        uint16_t cls = sys_get_be16(&msg[off + 2]);
+        uint32_t ttl = sys_get_be32(&msg[off + 4]);
+        uint16_t rdlen = sys_get_be16(&msg[off + 8]);
+        off += 10;
+        if ((size_t)off + rdlen > len) {
+            break;
+        }
+        if (type == DNS_TYPE_A && cls == DNS_CLASS_IN && rdlen == 4) {
+            memcpy(res->ipv4[res->count++], &msg[off], 4);
+            res->ttl_s = MIN(res->ttl_s, ttl);
+        }
+        off += rdlen;
+    }
+
+    return (res->count > 0) ? 0 : -ENOENT;
+}
+
+int dns_resolve_a(const struct uplink_endpoint *server, const char *name,
+                  struct dns_result *res, uint32_t wait_ms)
+{
+    uint8_t query[DNS_HDR_SIZE + DNS_NAME_MAX + 6];
+    static uint8_t reply[DNS_REPLY_MAX];
+    uint16_t id = (uint16_t)sys_rand32_get();
+
+    int qlen = dns_encode_query(id, name, query, sizeof(query));
+    if (qlen < 0) {
+        LOG_ERR("Bad host name '%s'", name);
+        return qlen;
+    }
+
+    uint16_t timeout_s = (uint16_t)MAX(1U, DIV_ROUND_UP(wait_ms, 1000U));
+    int rx_len = uplink_send(server, query, (size_t)qlen, reply, sizeof(reply), timeout_s, wait_ms);
+    if (rx_len < 0) {
+        return rx_len;
+    }
+    if (rx_len == 0) {
+        return -ETIMEDOUT;
+    }
+    return dns_parse_reply(id, reply, (size_t)rx_len, res);
+}
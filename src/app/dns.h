@@ -0,0 +1,40 @@
+#ifndef DNS_H
+#define DNS_H
+
+#include "uplink.h"
+#include <zephyr/types.h>
+
+/**
+ * @file dns.h
+ * @brief Minimal DNS A-record lookup over the uplink transport.
+ *
+ * One query, one reply, no recursion of our own. Unlike getaddrinfo() this
+ * returns the record TTL, which the endpoint cache needs, and it works on
+ * both uplink transports, including the lean nrf_socket one.
+ */
+
+#define DNS_MAX_ADDRS    2
+#define DNS_NAME_MAX     64
+#define DNS_PORT         53
+
+struct dns_result {
+    uint8_t ipv4[DNS_MAX_ADDRS][4];
+    uint8_t count;
+    uint32_t ttl_s;  // Smallest TTL among the returned A records
+};
+
+/**
+ * @brief Resolve @p name to up to DNS_MAX_ADDRS IPv4 addresses.
+ *
+ * @param server  Resolver to query.
+ * @param name    Host name, at most DNS_NAME_MAX characters.
+ * @param res     Result; valid only on success.
+ * @param wait_ms How long to wait for the reply.
+ *
+ * @return 0 on success, -ENOENT if the name has no A record, -ETIMEDOUT if
+ *         no reply arrived, other negative errno on transport or format errors.
+ */
+int dns_resolve_a(const struct uplink_endpoint *server, const char *name,
+                  struct dns_result *res, uint32_t wait_ms);
+
+#endif
@@ -0,0 +1,359 @@
+#include "endpoint.h"
+#include "storage.h"
+#include "retained.h"
+#include "watchdog_mgr.h"
+#include "../power/power_mgr.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <date_time.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(endpoint);
+
+#define ENDPOINT_CACHE_MAGIC   0x454E4450 // "ENDP"
+#define ENDPOINT_CACHE_VERSION 1
+
+#define HEALTH_INITIAL 128
+#define HEALTH_MAX     255
+
+/* Cache flags */
+#define CACHE_STALE (1 << 0) // A resolved address went unanswered
+
+struct endpoint_health {
+    uint8_t ipv4[4];
+    uint16_t port;
+    uint8_t score;
+    uint8_t fails;              // Consecutive unacknowledged attempts
+};
+
+struct endpoint_cache {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint8_t count;              // Resolved addresses
+    uint8_t health_count;
+    uint8_t addr[DNS_MAX_ADDRS][4];
+    uint32_t expires_unix;      // 0 if resolved before network time was known
+    uint32_t name_crc;          // Host name the addresses belong to
+    struct endpoint_health health[ENDPOINT_MAX];
+    uint32_t crc;
+};
+
+static struct endpoint_cache cache __retained;
+
+static struct uplink_endpoint primary;
+static struct uplink_endpoint fallbacks[ENDPOINT_FALLBACK_MAX];
+static size_t fallback_count;
+static struct uplink_endpoint dns_server = { .port = DNS_PORT };
+
+static bool has_hostname(void)
+{
+    return CONFIG_SEAL_SERVER_HOSTNAME[0] != '\0';
+}
+
+static uint32_t hostname_crc(void)
+{
+    return crc32_ieee((const uint8_t *)CONFIG_SEAL_SERVER_HOSTNAME,
+                      strlen(CONFIG_SEAL_SERVER_HOSTNAME));
+}
+
+static uint32_t cache_crc(void)
+{
+    return crc32_ieee((const uint8_t *)&cache, offsetof(struct endpoint_cache, crc));
+}
+
+static bool cache_is_valid(void)
+{
+    return (cache.magic == ENDPOINT_CACHE_MAGIC) && (cache.version == ENDPOINT_CACHE_VERSION) &&
+           (cache.crc == cache_crc()) && (cache.name_crc == hostname_crc());
+}
+
+static void cache_seal(void)
+{
+    cache.crc = cache_crc();
+}
+
+// Flash copy for the next cold boot; only written when addresses or failures change
+static void cache_persist(void)
+{
+    int rc = storage_write(NVS_ID_ENDPOINT, &cache, sizeof(cache));
+    if (rc < 0) {
+        LOG_WRN("Endpoint cache not saved: %d", rc);
+    }
+}
+
+static bool ep_equal(const struct uplink_endpoint *a, const struct uplink_endpoint *b)
+{
+    return (a->port == b->port) && (memcmp(a->ipv4, b->ipv4, sizeof(a->ipv4)) == 0);
+}
+
+static bool ep_is_resolved(const struct uplink_endpoint *ep)
+{
+    for (uint8_t i = 0; i < cache.count; i++) {
+        if (ep->port == primary.port && memcmp(ep->ipv4, cache.addr[i], 4) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static struct endpoint_health *health_find(const struct uplink_endpoint *ep)
+{
+    for (uint8_t i = 0; i < cache.health_count; i++) {
+        struct endpoint_health *h = &cache.health[i];
+        if (h->port == ep->port && memcmp(h->ipv4, ep->ipv4, sizeof(h->ipv4)) == 0) {
+            return h;
+        }
+    }
+    return NULL;
+}
+
+// "a.b.c.d" or "a.b.c.d:port"
+static int parse_endpoint(const char *str, size_t len, uint16_t default_port,
+                          struct uplink_endpoint *ep)
+{
+    char buf[sizeof("255.255.255.255:65535")];
+
+    if (len == 0 || len >= sizeof(buf)) {
+        return -EINVAL;
+    }
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+
+    ep->port = default_port;
+    char *colon = strchr(buf, ':');
+    if (colon != NULL) {
+        char *end;
+        unsigned long port = strtoul(colon + 1, &end, 10);
+        if (*end != '\0' || port == 0 || port > UINT16_MAX) {
+            return -EINVAL;
+        }
+        ep->port = (uint16_t)port;
+        *colon = '\0';
+    }
+    return uplink_parse_ipv4(buf, ep->ipv4);
+}
+
+static void parse_fallbacks(void)
+{
+    const char *s = CONFIG_SEAL_SERVER_FALLBACKS;
+
+    fallback_count = 0;
+    while (*s != '\0' && fallback_count < ENDPOINT_FALLBACK_MAX) {
+        const char *comma = strchr(s, ',');
+        size_t len = (comma != NULL) ? (size_t)(comma - s) : strlen(s);
+
+        if (parse_endpoint(s, len, primary.port, &fallbacks[fallback_count]) == 0) {
+            fallback_count++;
+        } else {
+            LOG_WRN("Ignoring fallback endpoint '%.*s'", (int)len, s);
+        }
+        s += len + ((comma != NULL) ? 1 : 0);
+    }
+}
+
+void endpoint_init(const struct uplink_endpoint *primary_ep)
+{
+    primary = *primary_ep;
+    parse_fallbacks();
+
+    if (cache_is_valid()) {
+        return;
+    }
+
+    // Retained copy lost (battery pull) or built for another host name
+    int rc = storage_read(NVS_ID_ENDPOINT, &cache, sizeof(cache));
+    if (rc != sizeof(cache) || !cache_is_valid()) {
+        memset(&cache, 0, sizeof(cache));
+        cache.magic = ENDPOINT_CACHE_MAGIC;
+        cache.version = ENDPOINT_CACHE_VERSION;
+        cache.name_crc = hostname_crc();
+        cache_seal();
+    }
+}
+
+static bool cache_expired(void)
+{
+    int64_t now_ms;
+
+    if (cache.count == 0) {
+        return true;
+    }
+    // Without network time the age is unknown; keep using the addresses until one fails
+    if (date_time_now(&now_ms) != 0) {
+        return false;
+    }
+    return (cache.expires_unix == 0) || ((uint32_t)(now_ms / 1000) >= cache.expires_unix);
+}
+
+static bool cache_needs_resolve(void)
+{
+    return has_hostname() && ((cache.flags & CACHE_STALE) || cache_expired());
+}
+
+// The configured resolver, else the one the network assigned with the PDN connection
+static int dns_server_get(struct uplink_endpoint *server)
+{
+    char addr[sizeof("255.255.255.255")];
+    const char *src = CONFIG_SEAL_DNS_SERVER;
+
+    if (src[0] == '\0') {
+        int rc = power_mgr_get_dns_server(addr, sizeof(addr));
+        if (rc < 0) {
+            LOG_WRN("No DNS server from the network: %d", rc);
+            return rc;
+        }
+        src = addr;
+    }
+    if (uplink_parse_ipv4(src, server->ipv4) < 0) {
+        LOG_ERR("Bad DNS server '%s'", src);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static int endpoint_resolve(void)
+{
+    struct dns_result res;
+    int rc = dns_server_get(&dns_server);
+    if (rc < 0) {
+        return rc;
+    }
+
+    int64_t start = k_uptime_get();
+
+    watchdog_mgr_stage_begin(WDT_STAGE_DNS, 2U * CONFIG_SEAL_DNS_TIMEOUT_MS);
+    rc = dns_resolve_a(&dns_server, CONFIG_SEAL_SERVER_HOSTNAME, &res, CONFIG_SEAL_DNS_TIMEOUT_MS);
+    watchdog_mgr_stage_end();
+    uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - start);
+
+    if (rc < 0) {
+        LOG_WRN("Resolving %s failed: %d (%u ms)", CONFIG_SEAL_SERVER_HOSTNAME, rc, elapsed_ms);
+        return rc;
+    }
+
+    uint32_t ttl_s = CLAMP(res.ttl_s, CONFIG_SEAL_DNS_TTL_MIN_SECONDS, CONFIG_SEAL_DNS_TTL_MAX_SECONDS);
+    int64_t now_ms;
+    // The flash copy only needs the addresses; a stale expiry there costs one lookup after a battery pull
+    bool changed = (cache.count != res.count) || (cache.flags & CACHE_STALE) ||
+                   (memcmp(cache.addr, res.ipv4, res.count * sizeof(res.ipv4[0])) != 0);
+
+    memcpy(cache.addr, res.ipv4, sizeof(res.ipv4));
+    cache.count = res.count;
+    cache.expires_unix = (date_time_now(&now_ms) == 0) ? (uint32_t)(now_ms / 1000) + ttl_s : 0;
+    cache.flags &= ~CACHE_STALE;
+    cache_seal();
+    if (changed) {
+        cache_persist();
+    }
+
+    LOG_INF("Resolved %s: %u address(es), ttl %u s, in %u ms",
+            CONFIG_SEAL_SERVER_HOSTNAME, res.count, ttl_s, elapsed_ms);
+    return 0;
+}
+
+size_t endpoint_select(struct uplink_endpoint *out, size_t cap, bool after_failure, bool *resolved)
+{
+    *resolved = false;
+    if (has_hostname() && (cache.count == 0 || (after_failure && cache_needs_resolve()))) {
+        *resolved = true;
+        endpoint_resolve();
+    }
+
+    // Resolved addresses first, then the primary literal, then fallbacks; ties keep this order
+    struct uplink_endpoint all[ENDPOINT_MAX];
+    size_t n = 0;
+
+    for (uint8_t i = 0; i < cache.count; i++) {
+        all[n].port = primary.port;
+        memcpy(all[n].ipv4, cache.addr[i], 4);
+        n++;
+    }
+    all[n++] = primary;
+    for (size_t i = 0; i < fallback_count; i++) {
+        all[n++] = fallbacks[i];
+    }
+
+    // Drop duplicates and carry scores over to this candidate set
+    struct endpoint_health health[ENDPOINT_MAX];
+    size_t unique = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        bool dup = false;
+        for (size_t j = 0; j < unique; j++) {
+            dup |= ep_equal(&all[i], &all[j]);
+        }
+        if (dup) {
+            continue;
+        }
+        all[unique] = all[i];
+        const struct endpoint_health *old = health_find(&all[i]);
+        if (old != NULL) {
+            health[unique] = *old;
+        } else {
+            memcpy(health[unique].ipv4, all[i].ipv4, 4);
+            health[unique].port = all[i].port;
+            health[unique].score = HEALTH_INITIAL;
+            health[unique].fails = 0;
+        }
+        unique++;
+    }
+    memcpy(cache.health, health, unique * sizeof(health[0]));
+    cache.health_count = (uint8_t)unique;
+    cache_seal();
+
+    // Stable insertion sort, best score first
+    for (size_t i = 1; i < unique; i++) {
+        struct uplink_endpoint ep = all[i];
+        struct endpoint_health h = health[i];
+        size_t j = i;
+        while (j > 0 && health[j - 1].score < h.score) {
+            all[j] = all[j - 1];
+            health[j] = health[j - 1];
+            j--;
+        }
+        all[j] = ep;
+        health[j] = h;
+    }
+
+    size_t count = MIN(unique, cap);
+    memcpy(out, all, count * sizeof(all[0]));
+    return count;
+}
+
+void endpoint_report(const struct uplink_endpoint *ep, bool acked)
+{
+    struct endpoint_health *h = health_find(ep);
+    if (h == NULL) {
+        return;
+    }
+
+    if (acked) {
+        h->score += (HEALTH_MAX - h->score + 3) / 4;
+        h->fails = 0;
+    } else {
+        h->score /= 2;
+        if (h->fails < UINT8_MAX) {
+            h->fails++;
+        }
+        if (ep_is_resolved(ep)) {
+            cache.flags |= CACHE_STALE;
+        }
+    }
+    cache_seal();
+
+    // Failures are rare and change the order for the next boot, so they are worth a flash write
+    if (!acked) {
+        cache_persist();
+    }
+}
+
+void endpoint_refresh(void)
+{
+    if (cache_needs_resolve()) {
+        endpoint_resolve();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include "uplink.h"
+#include "dns.h"
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file endpoint.h
+ * @brief Ingest server selection: hostname with cached DNS, plus fallbacks.
+ *
+ * Candidates are the addresses last resolved for CONFIG_SEAL_SERVER_HOSTNAME,
+ * the primary literal (provisioned, or CONFIG_SEAL_SERVER_ADDR) and
+ * CONFIG_SEAL_SERVER_FALLBACKS, ordered by a health score that rises with
+ * acknowledged alerts and halves on failures. Resolved addresses, their TTL
+ * and the scores are kept in retained RAM and backed by NVS, so an alert
+ * normally goes out without a DNS query. The hostname is resolved inline
+ * only when nothing was ever cached, or after every candidate has failed
+ * and the cache is expired or one of its addresses stopped answering.
+ */
+
+#define ENDPOINT_FALLBACK_MAX 3
+#define ENDPOINT_MAX (DNS_MAX_ADDRS + 1 + ENDPOINT_FALLBACK_MAX)
+
+/**
+ * @brief Load the cache and set the primary literal endpoint; once per boot.
+ *
+ * The hostname and fallbacks use the primary's port unless they carry their own.
+ */
+void endpoint_init(const struct uplink_endpoint *primary);
+
+/**
+ * @brief Candidates for this alert, best first.
+ *
+ * @param out           Candidate list.
+ * @param cap           Capacity of @p out (ENDPOINT_MAX covers every candidate).
+ * @param after_failure Every candidate of the previous list failed.
+ * @param resolved      Set to true if a DNS query was made.
+ *
+ * @return Number of candidates; at least 1 (the primary) when @p cap > 0.
+ */
+size_t endpoint_select(struct uplink_endpoint *out, size_t cap, bool after_failure, bool *resolved);
+
+/**
+ * @brief Score one attempt: @p acked is true if the server replied.
+ *
+ * A datagram that was sent but not acknowledged counts as a failure, since
+ * that is all a dead UDP server looks like.
+ */
+void endpoint_report(const struct uplink_endpoint *ep, bool acked);
+
+/**
+ * @brief Re-resolve the hostname if the cache is empty, expired or stale.
+ *
+ * Meant for moments when the modem is attached but no alert is waiting:
+ * right after the warm-monitoring attach, and after an alert went out.
+ */
+void endpoint_refresh(void);
+
+#endif
@@ -1,6 +1,14 @@
 #include "fsm.h"
 #include "storage.h"
+#include "retained.h"
 #include "payload.h"
+#include "log_ring.h"
+#include "latency.h"
+#include "config.h"
+#include "uplink.h"
+#include "endpoint.h"
+#include "link_policy.h"
+#include "provision.h"
 #include "watchdog_mgr.h" 
 #include "../drivers/veml6035.h"
 #include "../drivers/npm1300.h"
@@ -9,13 +17,10 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
-#include <modem/nrf_modem_lib.h>
-#include <zephyr/net/socket.h>
-#include <zephyr/posix/arpa/inet.h>
-#include <zephyr/posix/unistd.h>
-#include <zephyr/posix/sys/socket.h>
 #include <zephyr/sys/reboot.h>
+#include <zephyr/sys/byteorder.h>
 #include <errno.h>
+#include <string.h>
 
 LOG_MODULE_REGISTER(fsm);
 
@@ -30,16 +35,87 @@ static int64_t boot_time_ms = 0;
 /* Hardware Definitions */
 #define I2C_DEV_NODE DT_NODELABEL(i2c2)
 static const struct device *i2c_dev = DEVICE_DT_GET(I2C_DEV_NODE);
+static const struct device *pmic_i2c_dev = DEVICE_DT_GET(DT_NODELABEL(i2c1));
 
 #define SENSOR_INT_NODE DT_ALIAS(veml_int)
 static const struct gpio_dt_spec sensor_int = GPIO_DT_SPEC_GET(SENSOR_INT_NODE, gpios);
 
-/* Networking Config */
-#define SERVER_ADDR "203.0.113.10" /* TEST-NET-3 Public IP (Replace with actual) */
-#define SERVER_PORT 5000
-
 static enum app_state current_state = STATE_BOOT;
 
+/* Uptime at which the opening was detected (0 = the wake reset itself) */
+static int64_t trigger_time_ms = 0;
+
+// Keep the retained copy of the state in step with the FSM
+static void fsm_set_state(enum app_state state)
+{
+    current_state = state;
+    retained_get()->fsm_state = (uint8_t)state;
+    retained_update();
+}
+
+// Persist a flag to flash (battery-pull safe) and mirror it in retained RAM
+static void fsm_commit_flag(uint32_t flag)
+{
+    watchdog_mgr_stage_begin(WDT_STAGE_STORAGE, CONFIG_SEAL_STAGE_DEADLINE_STORAGE_MS);
+    int rc = storage_set_flag(flag);
+    watchdog_mgr_stage_end();
+    if (rc < 0) {
+        LOG_ERR("Failed to persist flag 0x%x: %d", flag, rc);
+    }
+    retained_get()->flags |= flag;
+    retained_update();
+}
+
+#if defined(CONFIG_SEAL_MULTI_EVENT)
+// Alert handled: wait for darkness again instead of terminating
+static void fsm_rearm(void)
+{
+    watchdog_mgr_stage_begin(WDT_STAGE_STORAGE, CONFIG_SEAL_STAGE_DEADLINE_STORAGE_MS);
+    int rc = storage_clear_flag(FLAG_TRIGGERED);
+    watchdog_mgr_stage_end();
+    if (rc < 0) {
+        LOG_ERR("Failed to clear trigger flag: %d", rc);
+    }
+    retained_get()->flags &= ~FLAG_TRIGGERED;
+    retained_update();
+
+    latency_reset();
+    LOG_INF("Re-arming for the next opening");
+    fsm_set_state(STATE_ARMING);
+}
+
+// Alert not delivered: FLAG_TRIGGERED stays set (a reset resumes it too), try again later
+static void fsm_retry_later(void)
+{
+    power_mgr_modem_off();
+    LOG_WRN("Alert not delivered, retrying in %d s", CONFIG_SEAL_ALERT_RETRY_SECONDS);
+    watchdog_mgr_sleep_s(CONFIG_SEAL_ALERT_RETRY_SECONDS);
+    fsm_set_state(STATE_TRANSMISSION);
+}
+#endif
+
+// Primary server: the provisioned endpoint, else the built-in literal (once per boot)
+static void fsm_init_endpoint(void)
+{
+    static bool done;
+    struct provision_identity id;
+
+    if (done) {
+        return;
+    }
+    done = true;
+
+    struct uplink_endpoint primary = { .port = CONFIG_SEAL_SERVER_PORT };
+
+    if (provision_get_identity(&id) == 0) {
+        memcpy(primary.ipv4, id.server_ipv4, sizeof(primary.ipv4));
+        primary.port = id.server_port;
+    } else {
+        uplink_parse_ipv4(CONFIG_SEAL_SERVER_ADDR, primary.ipv4);
+    }
+    endpoint_init(&primary);
+}
+
 // Forward declarations
 static void process_provisioning(void);
 static void process_arming(void);
@@ -56,43 +132,62 @@ int fsm_init(void)
     // Double Tap Reset Check
     uint8_t gpregret = (uint8_t)nrf_power_gpregret_get(NRF_POWER, 0);
     
-    if (gpregret == DOUBLE_RESET_MAGIC) {
+    if (IS_ENABLED(CONFIG_SEAL_DOUBLE_TAP_RESET) && gpregret == DOUBLE_RESET_MAGIC) {
         LOG_WRN("!!! DOUBLE TAP DETECTED - FACTORY RESET !!!");
         
         nrf_power_gpregret_set(NRF_POWER, 0, 0); 
         
+        retained_invalidate();
         storage_init();
         storage_reset();
         
         LOG_INF("Reset complete. Rebooting...");
         k_sleep(K_SECONDS(1));
         sys_reboot(SYS_REBOOT_COLD);
-    } else {
+    } else if (IS_ENABLED(CONFIG_SEAL_DOUBLE_TAP_RESET)) {
         nrf_power_gpregret_set(NRF_POWER, 0, DOUBLE_RESET_MAGIC);
     }
 
     boot_time_ms = k_uptime_get();
 
-    // Storage Init
-    rc = storage_init();
-    if (rc < 0) {
-        LOG_ERR("Storage init failed");
-        return rc;
+    // State Restoration: retained RAM first, flash only if it is invalid
+    bool from_retained = retained_init();
+    if (from_retained) {
+        flags = retained_get()->flags;
+    } else {
+        rc = storage_init();
+        if (rc < 0) {
+            LOG_ERR("Storage init failed");
+            return rc;
+        }
+        storage_get_flags(&flags);
     }
 
-    // State Restoration
-    storage_get_flags(&flags);
-
     if (flags & FLAG_TERMINATED) {
         current_state = STATE_TERMINATED;
     } else if (flags & FLAG_TRIGGERED) {
         current_state = STATE_TRANSMISSION; 
     } else if (flags & FLAG_PROVISIONED) {
-        current_state = STATE_MONITORING;
+        // A reboot while re-arming (e.g. into a staged config) must wait for darkness again
+        bool rearming = from_retained && retained_get()->fsm_state == STATE_ARMING;
+        current_state = rearming ? STATE_ARMING : STATE_MONITORING;
     } else {
         current_state = STATE_PROVISIONING;
     }
 
+    if (!from_retained) {
+        retained_reset(flags, (uint8_t)current_state);
+        // A resumed alert must keep the sequence it was triggered with
+        uint32_t seq = 0;
+        if (storage_read(NVS_ID_EVENT_SEQ, &seq, sizeof(seq)) == sizeof(seq)) {
+            retained_get()->seq_num = seq;
+            retained_update();
+        }
+    } else if (current_state == STATE_MONITORING) {
+        retained_get()->wake_count++;
+        retained_update();
+    }
+
     // Hardware Checks 
     if (current_state != STATE_TERMINATED) {
         if (!device_is_ready(i2c_dev)) {
@@ -126,8 +221,19 @@ int fsm_init(void)
              current_state = STATE_TRIGGERED;
          }
     }
+    fsm_set_state(current_state);
+
+    if (current_state == STATE_TRIGGERED) {
+        latency_set_trigger(0, 0);
+    } else if (current_state == STATE_TRANSMISSION) {
+        // Opened during an earlier boot; the elapsed time only covers this one
+        latency_set_trigger(0, LATENCY_FLAG_RESUMED);
+    }
+    latency_stage_end(LATENCY_STAGE_BOOT);
 
-    LOG_INF("FSM Init Complete. State=%d", current_state);
+    LOG_INF("FSM Init Complete. State=%d (%s), decision at %llu us, flash ops=%u",
+            current_state, from_retained ? "retained" : "flash",
+            k_ticks_to_us_floor64(k_uptime_ticks()), storage_get_access_count());
     return 0;
 }
 
@@ -135,7 +241,7 @@ int fsm_run(void)
 {
     // Clear Double Tap Magic if window expired
     int64_t now = k_uptime_get();
-    if ((now - boot_time_ms) > MIN_BOOT_WINDOW_MS) {
+    if (IS_ENABLED(CONFIG_SEAL_DOUBLE_TAP_RESET) && (now - boot_time_ms) > MIN_BOOT_WINDOW_MS) {
         if ((uint8_t)nrf_power_gpregret_get(NRF_POWER, 0) == DOUBLE_RESET_MAGIC) {
             nrf_power_gpregret_set(NRF_POWER, 0, 0);
         }
@@ -169,23 +275,44 @@ int fsm_run(void)
 static void process_provisioning(void)
 {
     LOG_INF("State: PROVISIONING");
-    current_state = STATE_ARMING;
+
+    int rc = provision_run();
+    if (rc == -ETIMEDOUT) {
+        LOG_WRN("No provisioning station, arming with built-in identity");
+    } else if (rc < 0 && rc != -ENOTSUP) {
+        LOG_ERR("Provisioning failed: %d", rc);
+    } else if (rc == 0) {
+        // config_init() ran before the overrides were stored
+        uint32_t wdt_timeout_ms = config_get()->wdt_timeout_ms;
+        config_reload();
+        if (config_get()->wdt_timeout_ms != wdt_timeout_ms) {
+            // The running watchdog cannot be reconfigured; the next boot installs the new timeout
+            LOG_INF("Provisioned watchdog timeout differs, rebooting");
+            sys_reboot(SYS_REBOOT_WARM);
+        }
+    }
+    fsm_set_state(STATE_ARMING);
 }
 
 static void process_arming(void)
 {
     LOG_INF("State: ARMING (Waiting for Darkness)");
     
-    // We need to confirm darkness for 2 mins
+    // We need to confirm darkness for 2 mins (by default)
     int consecutive_dark_seconds = 0;
-    const int target_dark_seconds = 120;
+    const int target_dark_seconds = config_get()->target_dark_seconds;
     uint16_t lux_counts = 0;
     int rc;
     
+    veml6035_set_int_threshold(config_get()->int_threshold);
+    watchdog_mgr_stage_begin(WDT_STAGE_SENSOR, CONFIG_SEAL_STAGE_DEADLINE_SENSOR_MS);
     veml6035_configure(i2c_dev);
+    watchdog_mgr_stage_end();
 
     while (consecutive_dark_seconds < target_dark_seconds) {
+        watchdog_mgr_stage_begin(WDT_STAGE_SENSOR, CONFIG_SEAL_STAGE_DEADLINE_SENSOR_MS);
         rc = veml6035_read_als(i2c_dev, &lux_counts);
+        watchdog_mgr_stage_end();
         if (rc < 0) {
             LOG_ERR("Failed to read sensor");
             k_sleep(K_SECONDS(1));
@@ -193,9 +320,11 @@ static void process_arming(void)
         }
 
         LOG_INF("Arming: Lux Counts=%d", lux_counts);
+        retained_get()->last_lux = lux_counts;
+        retained_update();
 
-        // Threshold verify (5 counts ~ 0.05 lux)
-        if (lux_counts < 5) {
+        // Threshold verify (5 counts ~ 0.05 lux by default)
+        if (lux_counts < config_get()->dark_threshold) {
             consecutive_dark_seconds++;
             LOG_INF("Darkness detected (%d/%d)", consecutive_dark_seconds, target_dark_seconds);
         } else {
@@ -203,13 +332,12 @@ static void process_arming(void)
             LOG_INF("Light detected! Resetting arming timer.");
         }
 
-        watchdog_mgr_kick();
-        k_sleep(K_SECONDS(1));
+        watchdog_mgr_sleep(K_SECONDS(1));
     }
     
     LOG_INF("Arming Complete! Locking device.");
-    storage_set_flag(FLAG_PROVISIONED);
-    current_state = STATE_MONITORING;
+    fsm_commit_flag(FLAG_PROVISIONED);
+    fsm_set_state(STATE_MONITORING);
 }
 
 // Helper to safely sleep
@@ -218,7 +346,7 @@ static void fsm_secure_sleep(void)
     int64_t now = k_uptime_get();
     int64_t diff = now - boot_time_ms;
     
-    if (diff < MIN_BOOT_WINDOW_MS) {
+    if (IS_ENABLED(CONFIG_SEAL_DOUBLE_TAP_RESET) && diff < MIN_BOOT_WINDOW_MS) {
         LOG_INF("Holding for Double Tap Window (%lld ms remaining)...", (MIN_BOOT_WINDOW_MS - diff));
         k_sleep(K_MSEC(MIN_BOOT_WINDOW_MS - diff));
     }
@@ -228,12 +356,80 @@ static void fsm_secure_sleep(void)
     power_mgr_system_off();
 }
 
+#if defined(CONFIG_SEAL_MONITOR_WARM_PSM)
+static K_SEM_DEFINE(sensor_trigger, 0, 1);
+static struct gpio_callback sensor_cb;
+
+static void sensor_isr(const struct device *port, struct gpio_callback *cb, uint32_t pins)
+{
+    ARG_UNUSED(port);
+    ARG_UNUSED(cb);
+    ARG_UNUSED(pins);
+
+    // Level interrupt: stays pending while the pin is active, so mask it until re-armed
+    gpio_pin_interrupt_configure_dt(&sensor_int, GPIO_INT_DISABLE);
+    trigger_time_ms = k_uptime_get();
+    k_sem_give(&sensor_trigger);
+}
+
+// Stay in System ON idle with the modem parked in PSM until the sensor fires
+static bool fsm_monitor_warm(void)
+{
+    if (power_mgr_modem_init() != 0) {
+        LOG_WRN("Warm attach failed, falling back to System OFF monitoring");
+        return false;
+    }
+
+    // Attached anyway: refresh the server address now rather than on the alert path
+    fsm_init_endpoint();
+    endpoint_refresh();
+
+    LOG_INF("Monitoring in System ON, modem in PSM...");
+
+    /*
+     * Level, like the System OFF wake: on nRF it uses the pin's SENSE
+     * mechanism, while an edge interrupt holds a GPIOTE IN channel that
+     * keeps the high-frequency clock request up during idle. A pin that
+     * is already active fires at once.
+     */
+    k_sem_reset(&sensor_trigger);
+    gpio_init_callback(&sensor_cb, sensor_isr, BIT(sensor_int.pin));
+    gpio_add_callback(sensor_int.port, &sensor_cb);
+    gpio_pin_interrupt_configure_dt(&sensor_int, GPIO_INT_LEVEL_ACTIVE);
+
+    // Wake only to feed the watchdog until the sensor fires, at least twice per timeout
+    k_timeout_t kick_period = K_MSEC(MIN(60000U, config_get()->wdt_timeout_ms / 2U));
+    watchdog_mgr_idle_enter();
+    while (k_sem_take(&sensor_trigger, kick_period) != 0) {
+        watchdog_mgr_kick();
+    }
+    watchdog_mgr_idle_exit();
+
+    // The ISR masked the pin; the next warm monitoring re-arms it
+    gpio_remove_callback(sensor_int.port, &sensor_cb);
+
+    LOG_INF("Sensor interrupt! Opening detected.");
+    latency_set_trigger(trigger_time_ms, LATENCY_FLAG_WARM);
+    fsm_set_state(STATE_TRIGGERED);
+    return true;
+}
+#endif
+
 static void process_monitoring(void)
 {
     LOG_INF("State: MONITORING");
     
     // Arm Sensor
+    veml6035_set_int_threshold(config_get()->int_threshold);
+    watchdog_mgr_stage_begin(WDT_STAGE_SENSOR, CONFIG_SEAL_STAGE_DEADLINE_SENSOR_MS);
     veml6035_configure(i2c_dev);
+    watchdog_mgr_stage_end();
+
+#if defined(CONFIG_SEAL_MONITOR_WARM_PSM)
+    if (fsm_monitor_warm()) {
+        return;
+    }
+#endif
     
     // Configure Wakeup GPIO
     gpio_pin_interrupt_configure_dt(&sensor_int, GPIO_INT_LEVEL_ACTIVE);
@@ -246,8 +442,151 @@ static void process_monitoring(void)
 static void process_triggered(void)
 {
     LOG_INF("State: TRIGGERED");
-    storage_set_flag(FLAG_TRIGGERED);
-    current_state = STATE_TRANSMISSION;
+
+    // One sequence per opening, written before the flag so a resumed alert reuses it
+    uint32_t seq = retained_get()->seq_num + 1;
+    watchdog_mgr_stage_begin(WDT_STAGE_STORAGE, CONFIG_SEAL_STAGE_DEADLINE_STORAGE_MS);
+    int rc = storage_write(NVS_ID_EVENT_SEQ, &seq, sizeof(seq));
+    watchdog_mgr_stage_end();
+    if (rc < 0) {
+        LOG_ERR("Failed to persist alert sequence: %d", rc);
+    }
+    retained_get()->seq_num = seq;
+    retained_update();
+
+    fsm_commit_flag(FLAG_TRIGGERED);
+    fsm_set_state(STATE_TRANSMISSION);
+}
+
+// Fixed header plus the TLVs that do not change between attempts
+static size_t fsm_build_payload_base(uint8_t *buf, size_t cap, bool minimal,
+                                     const struct provision_identity *id)
+{
+    seal_payload_t pkt = {0};
+    if (id != NULL) {
+        memcpy(pkt.device_id, id->device_id, sizeof(pkt.device_id));
+    }
+    pkt.status_code = 0x01; 
+    size_t len = PAYLOAD_SIZE;
+    payload_encode(&pkt, buf);
+
+    // Lets the server deduplicate retransmissions of the same opening
+    uint8_t event[4];
+    sys_put_le32(retained_get()->seq_num, event);
+    payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_EVENT, event, sizeof(event));
+
+    // Kept small enough to ride along even on a minimal alert
+    uint8_t stall[WATCHDOG_STALL_TLV_SIZE];
+    size_t stall_len = watchdog_mgr_stall_encode(stall, sizeof(stall));
+    if (stall_len > 0) {
+        payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_STALL, stall, (uint8_t)stall_len);
+    }
+
+    if (minimal) {
+        // Fewer bytes means fewer repetitions on air in deep coverage
+        return len;
+    }
+
+    const uint8_t fw[] = { SEAL_FW_VERSION_MAJOR, SEAL_FW_VERSION_MINOR };
+    payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_FW, fw, sizeof(fw));
+
+#if defined(CONFIG_SEAL_MULTI_EVENT)
+    // Lets the server decide whether a config delta is due; a single-alert seal never uses one
+    uint8_t cfg[3];
+    sys_put_le16(config_get()->seq, &cfg[0]);
+    cfg[2] = config_get()->trial;
+    payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_CONFIG, cfg, sizeof(cfg));
+#endif
+
+#if defined(CONFIG_SEAL_LOG_RING) && (CONFIG_SEAL_LOG_RING_UPLINK_BYTES > 0)
+    // Attach the newest log records so the server can decode what led up to this alert
+    static uint8_t log_tail[CONFIG_SEAL_LOG_RING_UPLINK_BYTES];
+    size_t log_len = log_ring_read_compressed(log_tail, sizeof(log_tail));
+    if (log_len > 0) {
+        payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_LOG, log_tail, (uint8_t)log_len);
+    }
+#endif
+    return len;
+}
+
+static size_t fsm_append_payload_radio(uint8_t *buf, size_t len, size_t cap,
+                                       enum link_strategy strategy, int defers,
+                                       const struct radio_metrics *m)
+{
+    uint8_t radio[10] = {0};
+    radio[0] = (uint8_t)strategy;
+    radio[1] = (uint8_t)defers;
+    if (m != NULL) {
+        sys_put_le16((uint16_t)m->rsrp, &radio[2]);
+        sys_put_le16((uint16_t)m->rsrq, &radio[4]);
+        sys_put_le16((uint16_t)m->tx_power, &radio[6]);
+        radio[8] = m->ce_level;
+        radio[9] = m->energy_estimate;
+    } else {
+        radio[8] = UINT8_MAX;
+    }
+    payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_RADIO, radio, sizeof(radio));
+    return len;
+}
+
+// Wait out poor coverage with the modem in PSM, then pick how to send
+static enum link_strategy fsm_choose_strategy(struct radio_metrics *metrics, bool *have_metrics,
+                                              int *defers)
+{
+    enum link_strategy strategy;
+    struct radio_metrics fresh;
+
+    *have_metrics = false;
+    for (;;) {
+        watchdog_mgr_stage_begin(WDT_STAGE_RADIO_EVAL, CONFIG_SEAL_STAGE_DEADLINE_RADIO_EVAL_MS);
+        int rc = power_mgr_get_radio_metrics(&fresh);
+        watchdog_mgr_stage_end();
+        if (rc == 0) {
+            *metrics = fresh;
+            *have_metrics = true;
+        } else if (*have_metrics) {
+            // Coming out of PSM the evaluation can fail; that is no sign coverage improved
+            LOG_WRN("Re-evaluation failed (%d), keeping the previous metrics", rc);
+        }
+        strategy = link_policy_decide(*have_metrics ? metrics : NULL, *defers);
+
+        if (*have_metrics) {
+            LOG_INF("Radio: RSRP %d dBm, RSRQ %d dB, CE%u, TX %d dBm, energy %u -> strategy %d",
+                    metrics->rsrp, metrics->rsrq, metrics->ce_level, metrics->tx_power,
+                    metrics->energy_estimate, strategy);
+        }
+        if (strategy != LINK_STRATEGY_DEFER) {
+            return strategy;
+        }
+
+        (*defers)++;
+        LOG_INF("Poor coverage, deferring %d s (%d/%d)", CONFIG_SEAL_TX_DEFER_SECONDS,
+                *defers, CONFIG_SEAL_TX_MAX_DEFERS);
+        // Start the deferral once the RRC connection is released, not while it is still up
+        int park_rc = power_mgr_modem_park();
+        if (park_rc < 0) {
+            LOG_WRN("Deferring without PSM: %d", park_rc);
+        }
+
+        watchdog_mgr_sleep_s(CONFIG_SEAL_TX_DEFER_SECONDS);
+    }
+}
+
+// Per-attempt TLVs: timings are taken right before the datagram goes out
+static size_t fsm_append_payload_timing(uint8_t *buf, size_t len, size_t cap, bool minimal)
+{
+    uint32_t id, tac;
+    if (!minimal && power_mgr_get_cell(&id, &tac) == 0) {
+        uint8_t cell[6];
+        sys_put_le32(id, &cell[0]);
+        sys_put_le16((uint16_t)tac, &cell[4]);
+        payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_CELL, cell, sizeof(cell));
+    }
+
+    uint8_t lat[LATENCY_TLV_SIZE];
+    latency_encode(lat, sizeof(lat));
+    payload_append_tlv(buf, &len, cap, PAYLOAD_TLV_LATENCY, lat, sizeof(lat));
+    return len;
 }
 
 static void process_transmission(void)
@@ -255,86 +594,151 @@ static void process_transmission(void)
     LOG_INF("State: TRANSMISSION");
     
     // Defer Modem Init to here
+    latency_stage_begin(LATENCY_STAGE_ATTACH);
+    watchdog_mgr_stage_begin(WDT_STAGE_ATTACH, CONFIG_SEAL_STAGE_DEADLINE_ATTACH_MS);
     int err = power_mgr_modem_init();
+    watchdog_mgr_stage_end();
+    latency_stage_end(LATENCY_STAGE_ATTACH);
     if (err) {
         LOG_ERR("Modem init failed: %d", err);
-        storage_set_flag(FLAG_TERMINATED);
-        current_state = STATE_TERMINATED;
+#if defined(CONFIG_SEAL_MULTI_EVENT)
+        fsm_retry_later();
+#else
+        fsm_commit_flag(FLAG_TERMINATED);
+        fsm_set_state(STATE_TERMINATED);
+#endif
         return;
     }
     
-    int sock = -1;
-    struct sockaddr_in server;
     bool success = false;
-    int retries_left = 3;
-
-    seal_payload_t pkt = {0};
-    pkt.status_code = 0x01; 
-    uint8_t raw_buf[PAYLOAD_SIZE];
-    payload_encode(&pkt, raw_buf);
-
-    server.sin_family = AF_INET;
-    server.sin_port = htons(SERVER_PORT);
-    inet_pton(AF_INET, SERVER_ADDR, &server.sin_addr);
+    const struct seal_config *cfg = config_get();
+    int retries_left = cfg->tx_retries;
+    uint8_t downlink[64];
+    int downlink_len = 0;
+
+    struct radio_metrics metrics;
+    bool have_metrics;
+    int defers = 0;
+    enum link_strategy strategy = fsm_choose_strategy(&metrics, &have_metrics, &defers);
+
+    static uint8_t raw_buf[PAYLOAD_MAX_SIZE];
+    size_t base_len;
+    size_t tx_len;
+
+    struct provision_identity id;
+    bool provisioned = (provision_get_identity(&id) == 0);
+
+    base_len = fsm_build_payload_base(raw_buf, sizeof(raw_buf),
+                                      strategy == LINK_STRATEGY_MINIMAL,
+                                      provisioned ? &id : NULL);
+    base_len = fsm_append_payload_radio(raw_buf, base_len, sizeof(raw_buf), strategy, defers,
+                                        have_metrics ? &metrics : NULL);
+
+    latency_stage_begin(LATENCY_STAGE_SEND);
+
+    // Healthiest endpoint first; a DNS query only if nothing was ever resolved
+    fsm_init_endpoint();
+    struct uplink_endpoint servers[ENDPOINT_MAX];
+    bool resolved;
+    size_t n_servers = endpoint_select(servers, ARRAY_SIZE(servers), false, &resolved);
+    size_t next = 0;
+    if (resolved) {
+        latency_add_flags(LATENCY_FLAG_DNS);
+    }
 
     while (!success && retries_left > 0) {
-        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-        if (sock < 0) {
-            LOG_ERR("Socket fail: %d", errno);
-            goto retry;
+        if (next == n_servers) {
+            // Every candidate failed once: re-resolve if the cache is due, then start over
+            n_servers = endpoint_select(servers, ARRAY_SIZE(servers), true, &resolved);
+            next = 0;
+            if (resolved) {
+                latency_add_flags(LATENCY_FLAG_DNS);
+            }
         }
-
-        // Set Socket Timeouts (Fix 5)
-        struct timeval timeout = {
-            .tv_sec = 60,
-            .tv_usec = 0,
-        };
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-
-        err = connect(sock, (struct sockaddr *)&server, sizeof(server));
-        if (err < 0) {
-            LOG_ERR("Connect fail: %d", errno); 
-            close(sock);
-            goto retry;
+        const struct uplink_endpoint *server = &servers[next++];
+
+        retained_get()->ledger.tx_attempts++;
+        retained_update();
+        latency_count_attempt();
+
+        tx_len = fsm_append_payload_timing(raw_buf, base_len, sizeof(raw_buf),
+                                           strategy == LINK_STRATEGY_MINIMAL);
+        // Connect and send may each block for the socket timeout, then the reply window
+        watchdog_mgr_stage_begin(WDT_STAGE_SEND, 2U * cfg->sock_timeout_s * 1000U +
+                                                 CONFIG_SEAL_DOWNLINK_WAIT_MS);
+        // The server may piggyback a config delta on its acknowledgement
+        err = uplink_send(server, raw_buf, tx_len, downlink, sizeof(downlink),
+                          cfg->sock_timeout_s, CONFIG_SEAL_DOWNLINK_WAIT_MS);
+        watchdog_mgr_stage_end();
+        // Without a reply window every sent datagram counts as acknowledged
+        bool acked = (err > 0) || (err == 0 && CONFIG_SEAL_DOWNLINK_WAIT_MS == 0);
+        endpoint_report(server, acked);
+        // Sent but unanswered: try another endpoint if one and an attempt are left, else it stays sent
+        if (acked || (err == 0 && (next == n_servers || retries_left == 1))) {
+            LOG_INF("Payload Sent! Trigger-to-send: %lld ms", k_uptime_get() - trigger_time_ms);
+            success = true;
+            downlink_len = err;
+            break;
         }
 
-        err = send(sock, raw_buf, sizeof(seal_payload_t), 0);
-        if (err < 0) {
-             LOG_ERR("Send fail: %d", errno);
-             close(sock);
-             goto retry;
-        } else {
-             LOG_INF("Payload Sent!");
-             success = true;
-             close(sock);
-             break;
+        LOG_WRN("Retrying tx%s...", (err == 0) ? " (no acknowledgement)" : "");
+        retries_left--;
+        // Fail over to the next endpoint right away; back off once all have failed
+        if (next == n_servers) {
+            watchdog_mgr_sleep_s(cfg->retry_delay_s);
         }
+    }
 
-    retry:
-        if (!success) {
-            LOG_WRN("Retrying tx...");
-            retries_left--;
-            watchdog_mgr_kick();
-            k_sleep(K_SECONDS(60));
+    // Confirm (or roll back) a trial config before staging a new one
+    config_report_uplink(success, downlink_len > 0);
+    // Only a reply proves the stall record arrived; a datagram sent into silence keeps it
+    if (downlink_len > 0) {
+        watchdog_mgr_stall_clear();
+        if (IS_ENABLED(CONFIG_SEAL_MULTI_EVENT)) {
+            err = config_apply_downlink(downlink, downlink_len);
+            if (err < 0) {
+                LOG_WRN("Downlink ignored: %d", err);
+            }
         }
     }
-
     if (success) {
-        storage_set_flag(FLAG_TERMINATED);
-        current_state = STATE_TERMINATED;
+        // Still attached and the alert is out: renew an expired cache off the alert path
+        endpoint_refresh();
     } else {
         LOG_ERR("Transmission Failed.");
-        storage_set_flag(FLAG_TERMINATED); 
-        current_state = STATE_TERMINATED;
     }
+
+#if defined(CONFIG_SEAL_MULTI_EVENT)
+    if (!success) {
+        fsm_retry_later();
+        return;
+    }
+#if defined(CONFIG_SEAL_MONITOR_WARM_PSM)
+    if (config_staged()) {
+        // Warm monitoring never boots again on its own; re-arm in the staged config
+        power_mgr_modem_off();
+        fsm_rearm();
+        LOG_INF("Rebooting into the staged config");
+        sys_reboot(SYS_REBOOT_WARM);
+    }
+    // Warm monitoring reuses the attach for the next opening
+    power_mgr_modem_park();
+#else
+    // Arming can take hours in the light; System OFF monitoring needs the modem off anyway
+    power_mgr_modem_off();
+#endif
+    fsm_rearm();
+#else
+    fsm_commit_flag(FLAG_TERMINATED);
+    fsm_set_state(STATE_TERMINATED);
+#endif
 }
 
 static void process_termination(void)
 {
     LOG_INF("State: TERMINATED");
     veml6035_shutdown(i2c_dev);
-    npm1300_hibernate(i2c_dev); 
+    npm1300_hibernate(pmic_i2c_dev);
     
     fsm_secure_sleep();
 }
@@ -0,0 +1,70 @@
+#include "latency.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+static int64_t trigger_ms = 0;
+static uint8_t trigger_flags = 0;
+static int64_t stage_start_ms[LATENCY_STAGE_COUNT];
+static uint32_t stage_ms[LATENCY_STAGE_COUNT];
+static uint8_t attempts = 0;
+
+void latency_set_trigger(int64_t uptime_ms, uint8_t flags)
+{
+    trigger_ms = uptime_ms;
+    trigger_flags = flags;
+}
+
+void latency_add_flags(uint8_t flags)
+{
+    trigger_flags |= flags;
+}
+
+void latency_reset(void)
+{
+    trigger_ms = 0;
+    trigger_flags = 0;
+    memset(stage_start_ms, 0, sizeof(stage_start_ms));
+    memset(stage_ms, 0, sizeof(stage_ms));
+    attempts = 0;
+}
+
+void latency_stage_begin(enum latency_stage stage)
+{
+    stage_start_ms[stage] = k_uptime_get();
+}
+
+void latency_stage_end(enum latency_stage stage)
+{
+    stage_ms[stage] = (uint32_t)(k_uptime_get() - stage_start_ms[stage]);
+}
+
+void latency_count_attempt(void)
+{
+    if (attempts < UINT8_MAX) {
+        attempts++;
+    }
+}
+
+size_t latency_encode(uint8_t *out, size_t cap)
+{
+    if (cap < LATENCY_TLV_SIZE) {
+        return 0;
+    }
+
+    int64_t now = k_uptime_get();
+
+    // The send stage is still running while the payload is being built
+    uint32_t send_ms = 0;
+    if (stage_start_ms[LATENCY_STAGE_SEND] > 0) {
+        send_ms = (uint32_t)(now - stage_start_ms[LATENCY_STAGE_SEND]);
+    }
+
+    sys_put_le32((uint32_t)(now - trigger_ms), &out[0]);
+    sys_put_le32(stage_ms[LATENCY_STAGE_BOOT], &out[4]);
+    sys_put_le32(stage_ms[LATENCY_STAGE_ATTACH], &out[8]);
+    sys_put_le32(send_ms, &out[12]);
+    out[16] = attempts;
+    out[17] = trigger_flags;
+    return LATENCY_TLV_SIZE;
+}
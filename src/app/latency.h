@@ -0,0 +1,62 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/**
+ * @file latency.h
+ * @brief Trigger-to-uplink latency accounting reported in the alert payload.
+ */
+
+enum latency_stage {
+    LATENCY_STAGE_BOOT,   // Reset to FSM decision
+    LATENCY_STAGE_ATTACH, // Modem init and LTE attach
+    LATENCY_STAGE_SEND,   // First send attempt to the current one
+    LATENCY_STAGE_COUNT
+};
+
+/* Flags carried in the latency TLV */
+#define LATENCY_FLAG_WARM     (1 << 0) // Trigger timed from the sensor interrupt, not a wake reset
+#define LATENCY_FLAG_RESUMED  (1 << 1) // Trigger happened in an earlier boot; elapsed time is a lower bound
+#define LATENCY_FLAG_DNS      (1 << 2) // A DNS lookup ran on the alert path
+
+/* Encoded size of the latency TLV value */
+#define LATENCY_TLV_SIZE 18
+
+/**
+ * @brief Record the uptime at which the trigger was observed.
+ * @param uptime_ms 0 when the trigger was the wake reset itself.
+ */
+void latency_set_trigger(int64_t uptime_ms, uint8_t flags);
+
+/**
+ * @brief Add flags found out after the trigger (e.g. LATENCY_FLAG_DNS).
+ */
+void latency_add_flags(uint8_t flags);
+
+/**
+ * @brief Forget the previous alert's trigger, stages and attempts (multi-event re-arm).
+ */
+void latency_reset(void);
+
+void latency_stage_begin(enum latency_stage stage);
+void latency_stage_end(enum latency_stage stage);
+
+/**
+ * @brief Count one uplink attempt (socket creation to send result).
+ */
+void latency_count_attempt(void);
+
+/**
+ * @brief Encode the latency TLV value, timed at the moment of the call.
+ *
+ * Layout (little endian): since_trigger_ms u32, boot_ms u32, attach_ms u32,
+ * send_ms u32, attempts u8, flags u8. send_ms runs from the start of the
+ * first attempt up to this call, so it includes retry back-off.
+ *
+ * @return Number of bytes written (LATENCY_TLV_SIZE), or 0 if @p cap is too small.
+ */
+size_t latency_encode(uint8_t *out, size_t cap);
+
+#endif
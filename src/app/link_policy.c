@@ -0,0 +1,22 @@
+#include "link_policy.h"
+#include <modem/lte_lc.h>
+
+enum link_strategy link_policy_decide(const struct radio_metrics *metrics, int defers)
+{
+    if (metrics == NULL) {
+        // No information: do not hold back an alert on a guess
+        return LINK_STRATEGY_SEND_NOW;
+    }
+
+    bool deep = (metrics->ce_level != LTE_LC_CE_LEVEL_UNKNOWN &&
+                 metrics->ce_level >= LTE_LC_CE_LEVEL_2) ||
+                (metrics->energy_estimate == LTE_LC_ENERGY_CONSUMPTION_EXCESSIVE);
+
+    if (deep) {
+        return (defers < CONFIG_SEAL_TX_MAX_DEFERS) ? LINK_STRATEGY_DEFER : LINK_STRATEGY_MINIMAL;
+    }
+    if (metrics->energy_estimate == LTE_LC_ENERGY_CONSUMPTION_INCREASED) {
+        return LINK_STRATEGY_MINIMAL;
+    }
+    return LINK_STRATEGY_SEND_NOW;
+}
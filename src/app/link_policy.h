@@ -0,0 +1,29 @@
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include "../power/power_mgr.h"
+
+/**
+ * @file link_policy.h
+ * @brief Choose how to send an alert given the radio conditions after attach.
+ *
+ * In deep coverage (CE level 2+) one send can cost tens of times the energy
+ * of a good-coverage send, so poor conditions are first waited out with the
+ * modem in PSM, then the alert is shrunk to its minimal form.
+ */
+
+enum link_strategy {
+    LINK_STRATEGY_SEND_NOW = 0, // Full payload immediately
+    LINK_STRATEGY_DEFER = 1,    // Park in PSM, re-measure later
+    LINK_STRATEGY_MINIMAL = 2,  // Header and radio telemetry only
+};
+
+/**
+ * @brief Decide the strategy for the next attempt.
+ *
+ * @param metrics Radio metrics, or NULL if the modem could not evaluate.
+ * @param defers  Deferrals already spent on this alert.
+ */
+enum link_strategy link_policy_decide(const struct radio_metrics *metrics, int defers);
+
+#endif
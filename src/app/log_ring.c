@@ -0,0 +1,292 @@
+#include "log_ring.h"
+#include "retained.h"
+#include "../power/power_mgr.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_output.h>
+#include <zephyr/logging/log_output_dict.h>
+#include <zephyr/spinlock.h>
+#include <string.h>
+
+#define LOG_RING_MAGIC      0x4C4F4752 // "LOGR"
+#define LOG_RING_SIZE       CONFIG_SEAL_LOG_RING_SIZE
+#define LOG_RING_MAX_RECORD 255
+/* Newest raw bytes considered for the uplink tail; compressed outside the lock */
+#define LOG_RING_SNAPSHOT   MIN(LOG_RING_SIZE, 1024)
+
+struct log_ring {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t tail;     // Offset of the oldest record
+    uint32_t used;     // Bytes in use, including length prefixes
+    uint32_t dropped;  // Records evicted since the ring was reset
+    uint8_t data[LOG_RING_SIZE];
+};
+
+static struct log_ring ring __retained;
+static struct k_spinlock lock;
+
+/* Staging for the message currently being encoded */
+static uint8_t staging[LOG_RING_MAX_RECORD];
+static size_t staging_len;
+static bool staging_overflow;
+
+static const struct device *const console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+static inline uint8_t ring_byte(uint32_t pos)
+{
+    return ring.data[pos % LOG_RING_SIZE];
+}
+
+static void ring_reset(void)
+{
+    ring.magic = LOG_RING_MAGIC;
+    ring.size = LOG_RING_SIZE;
+    ring.tail = 0;
+    ring.used = 0;
+    ring.dropped = 0;
+}
+
+static void ring_commit(const uint8_t *rec, size_t len)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    // Evict whole records until the new one fits
+    while ((LOG_RING_SIZE - ring.used) < (len + 1)) {
+        uint32_t old_len = ring_byte(ring.tail) + 1;
+        ring.tail = (ring.tail + old_len) % LOG_RING_SIZE;
+        ring.used -= old_len;
+        ring.dropped++;
+    }
+
+    uint32_t head = (ring.tail + ring.used) % LOG_RING_SIZE;
+    ring.data[head] = (uint8_t)len;
+    for (size_t i = 0; i < len; i++) {
+        ring.data[(head + 1 + i) % LOG_RING_SIZE] = rec[i];
+    }
+    ring.used += len + 1;
+
+    k_spin_unlock(&lock, key);
+}
+
+static int ring_out(uint8_t *data, size_t length, void *ctx)
+{
+    ARG_UNUSED(ctx);
+
+    size_t copy = length;
+    size_t room = sizeof(staging) - staging_len;
+    if (copy > room) {
+        // Oversized records are dropped on commit
+        staging_overflow = true;
+        copy = room;
+    }
+    memcpy(&staging[staging_len], data, copy);
+    staging_len += copy;
+
+    return (int)length;
+}
+
+static uint8_t output_buf[64];
+LOG_OUTPUT_DEFINE(log_output_ring, ring_out, output_buf, sizeof(output_buf));
+
+static void process(const struct log_backend *const backend, union log_msg_generic *msg)
+{
+    ARG_UNUSED(backend);
+
+    staging_len = 0;
+    staging_overflow = false;
+
+    log_dict_output_msg_process(&log_output_ring, &msg->log, 0);
+    log_output_flush(&log_output_ring);
+
+    if (!staging_overflow && staging_len > 0) {
+        ring_commit(staging, staging_len);
+    }
+}
+
+static void dropped(const struct log_backend *const backend, uint32_t cnt)
+{
+    ARG_UNUSED(backend);
+
+    staging_len = 0;
+    staging_overflow = false;
+
+    log_dict_output_dropped_process(&log_output_ring, cnt);
+    log_output_flush(&log_output_ring);
+
+    if (!staging_overflow && staging_len > 0) {
+        ring_commit(staging, staging_len);
+    }
+}
+
+static void panic(const struct log_backend *const backend)
+{
+    ARG_UNUSED(backend);
+    // Records are already in RAM; nothing to flush
+}
+
+static void init(const struct log_backend *const backend)
+{
+    ARG_UNUSED(backend);
+
+    if ((ring.magic != LOG_RING_MAGIC) || (ring.size != LOG_RING_SIZE) ||
+        (ring.tail >= LOG_RING_SIZE) || (ring.used > LOG_RING_SIZE)) {
+        ring_reset();
+    }
+}
+
+static const struct log_backend_api log_backend_ring_api = {
+    .process = process,
+    .dropped = dropped,
+    .panic = panic,
+    .init = init,
+};
+
+LOG_BACKEND_DEFINE(log_backend_ring, log_backend_ring_api, true);
+
+static void uart_puts(const char *s)
+{
+    while (*s) {
+        uart_poll_out(console, *s++);
+    }
+}
+
+void log_ring_dump(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[8];
+
+    if (!device_is_ready(console)) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint32_t tail = ring.tail;
+    uint32_t used = ring.used;
+    k_spin_unlock(&lock, key);
+
+    uart_puts("\r\n#LR:BEGIN\r\n");
+    for (uint32_t i = 0; i < used; i++) {
+        if ((i % 32) == 0) {
+            uart_puts(i ? "\r\n#LR:" : "#LR:");
+        }
+        uint8_t b = ring_byte(tail + i);
+        line[0] = hex[b >> 4];
+        line[1] = hex[b & 0x0F];
+        line[2] = '\0';
+        uart_puts(line);
+    }
+    uart_puts("\r\n#LR:END\r\n");
+}
+
+void log_ring_dump_on_request(void)
+{
+    if (!(power_mgr_reset_cause() & RESET_PIN)) {
+        return;
+    }
+    if (!device_is_ready(console)) {
+        return;
+    }
+
+    int64_t deadline = k_uptime_get() + CONFIG_SEAL_LOG_RING_DUMP_WINDOW_MS;
+    unsigned char c;
+
+    while (k_uptime_get() < deadline) {
+        if (uart_poll_in(console, &c) == 0 && c == 'D') {
+            log_ring_dump();
+            return;
+        }
+        k_sleep(K_MSEC(1));
+    }
+}
+
+// Zero-run compressed size of one framed record
+static size_t record_compressed_size(const uint8_t *rec, uint32_t len)
+{
+    size_t out = 0;
+    uint32_t i = 0;
+
+    while (i < len) {
+        if (rec[i] == 0) {
+            uint32_t run = 0;
+            while (i < len && rec[i] == 0 && run < 255) {
+                run++;
+                i++;
+            }
+            out += 2;
+        } else {
+            out++;
+            i++;
+        }
+    }
+    return out;
+}
+
+static size_t record_compress(const uint8_t *rec, uint32_t len, uint8_t *out)
+{
+    size_t o = 0;
+    uint32_t i = 0;
+
+    while (i < len) {
+        uint8_t b = rec[i];
+        if (b == 0) {
+            uint8_t run = 0;
+            while (i < len && rec[i] == 0 && run < 255) {
+                run++;
+                i++;
+            }
+            out[o++] = 0x00;
+            out[o++] = run;
+        } else {
+            out[o++] = b;
+            i++;
+        }
+    }
+    return o;
+}
+
+size_t log_ring_read_compressed(uint8_t *out, size_t cap)
+{
+    static uint8_t snap[LOG_RING_SNAPSHOT];
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    // Under the lock only walk length prefixes and copy the newest whole records out
+    uint32_t start = 0;
+    while ((ring.used - start) > sizeof(snap)) {
+        start += ring_byte(ring.tail + start) + 1;
+    }
+    uint32_t used = ring.used - start;
+    for (uint32_t i = 0; i < used; i++) {
+        snap[i] = ring_byte(ring.tail + start + i);
+    }
+
+    k_spin_unlock(&lock, key);
+
+    // Pass 1: total compressed size of all records
+    size_t total = 0;
+    for (uint32_t off = 0; off < used; ) {
+        uint32_t len = snap[off] + 1;
+        total += record_compressed_size(&snap[off], len);
+        off += len;
+    }
+
+    // Pass 2: skip the oldest records until the rest fits
+    start = 0;
+    while (start < used && total > cap) {
+        uint32_t len = snap[start] + 1;
+        total -= record_compressed_size(&snap[start], len);
+        start += len;
+    }
+
+    // Pass 3: encode
+    size_t written = 0;
+    for (uint32_t off = start; off < used; ) {
+        uint32_t len = snap[off] + 1;
+        written += record_compress(&snap[off], len, &out[written]);
+        off += len;
+    }
+    return written;
+}
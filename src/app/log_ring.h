@@ -0,0 +1,40 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/**
+ * @file log_ring.h
+ * @brief Dictionary-encoded log backend writing into a retained RAM ring.
+ *
+ * Each log message is stored as one framed record: [len][dictionary bytes].
+ * The oldest records are evicted whole when the ring is full.
+ */
+
+/**
+ * @brief Dump the ring over the console UART if one was requested.
+ *
+ * Only listens after a pin reset, so the System OFF wake path is unaffected.
+ * A 'D' received within CONFIG_SEAL_LOG_RING_DUMP_WINDOW_MS triggers the dump.
+ */
+void log_ring_dump_on_request(void);
+
+/**
+ * @brief Write the whole ring as "#LR:" prefixed hex lines to the console UART.
+ */
+void log_ring_dump(void);
+
+/**
+ * @brief Copy the newest records that fit into @p out, zero-run compressed.
+ *
+ * Only the newest 1 KB of the ring is considered. It is copied out under the
+ * lock and compressed after the lock is released.
+ *
+ * Compression: a 0x00 byte is followed by the run length (1..255) of zeros.
+ *
+ * @return Number of bytes written to @p out.
+ */
+size_t log_ring_read_compressed(uint8_t *out, size_t cap);
+
+#endif
@@ -1,8 +1,23 @@
 #include "payload.h"
 #include <string.h>
+#include <errno.h>
 
 void payload_encode(seal_payload_t *payload, uint8_t *buffer)
 {
     // Simple memcpy 
     memcpy(buffer, payload, sizeof(seal_payload_t));
 }
+
+int payload_append_tlv(uint8_t *buffer, size_t *len, size_t cap,
+                       uint8_t type, const uint8_t *value, uint8_t value_len)
+{
+    if ((*len + 2 + value_len) > cap) {
+        return -ENOMEM;
+    }
+
+    buffer[*len] = type;
+    buffer[*len + 1] = value_len;
+    memcpy(&buffer[*len + 2], value, value_len);
+    *len += 2 + value_len;
+    return 0;
+}
@@ -2,8 +2,24 @@
 #define PAYLOAD_H
 
 #include <zephyr/types.h>
+#include <stddef.h>
 
 #define PAYLOAD_SIZE 17
+#define PAYLOAD_MAX_SIZE 256
+
+/* Optional TLV records appended after the fixed 17-byte header: [type][len][value] */
+#define PAYLOAD_TLV_LOG     0x10 // Zero-run compressed dictionary log records
+#define PAYLOAD_TLV_LATENCY 0x11 // Trigger-relative stage timings (see latency.h)
+#define PAYLOAD_TLV_FW      0x12 // Firmware version: major u8, minor u8
+#define PAYLOAD_TLV_CELL    0x13 // Serving cell: cell id u32, tracking area code u16 (LE)
+#define PAYLOAD_TLV_CONFIG  0x14 // Active config: seq u16 (LE), trial u8
+#define PAYLOAD_TLV_RADIO   0x15 // strategy u8, defers u8, rsrp i16, rsrq i16, tx_power i16, ce u8, energy u8 (LE)
+#define PAYLOAD_TLV_STALL   0x16 // Watchdog/stage-deadline stall record (see watchdog_mgr.h)
+#define PAYLOAD_TLV_EVENT   0x17 // Alert sequence u32 (LE): same for every retransmission of one trigger
+
+/* Firmware version reported in PAYLOAD_TLV_FW */
+#define SEAL_FW_VERSION_MAJOR 1
+#define SEAL_FW_VERSION_MINOR 1
 
 typedef struct {
     uint8_t device_id[16]; // UUID or Serial
@@ -12,4 +28,15 @@ typedef struct {
 
 void payload_encode(seal_payload_t *payload, uint8_t *buffer);
 
+/**
+ * @brief Append a TLV record to an encoded payload.
+ *
+ * @param buffer Encoded payload.
+ * @param len    Current payload length; advanced on success.
+ * @param cap    Capacity of @p buffer.
+ * @return 0 on success, -ENOMEM if the record does not fit.
+ */
+int payload_append_tlv(uint8_t *buffer, size_t *len, size_t cap,
+                       uint8_t type, const uint8_t *value, uint8_t value_len);
+
 #endif
@@ -0,0 +1,426 @@
+#include "provision.h"
+#include "storage.h"
+#include "config.h"
+#include "watchdog_mgr.h"
+#include "../drivers/veml6035.h"
+#include "../drivers/npm1300.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/drivers/hwinfo.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(CONFIG_SEAL_PROVISIONING)
+#include <psa/crypto.h>
+#endif
+
+LOG_MODULE_REGISTER(provision);
+
+/* Bundle field offsets (see provision.h) */
+#define B_VERSION    0
+#define B_HW_ID      2
+#define B_DEVICE_ID  10
+#define B_IPV4       26
+#define B_PORT       30
+#define B_DEVICE_KEY 32
+#define B_CFG_COUNT  64
+#define B_CFG        PROVISION_BUNDLE_FIXED
+
+static size_t bundle_signed_len(uint8_t cfg_count)
+{
+    return PROVISION_BUNDLE_FIXED + (size_t)cfg_count * SEAL_CFG_DOWNLINK_ENTRY;
+}
+
+// Structural check only; the signature is checked on receipt, not on every read
+static int bundle_check(const uint8_t *b, size_t len)
+{
+    if (len < PROVISION_BUNDLE_FIXED + PROVISION_SIG_SIZE ||
+        b[B_VERSION] != PROVISION_BUNDLE_VERSION ||
+        b[B_CFG_COUNT] > PROVISION_MAX_CFG ||
+        len != bundle_signed_len(b[B_CFG_COUNT]) + PROVISION_SIG_SIZE) {
+        return -EBADMSG;
+    }
+    return 0;
+}
+
+static int bundle_load(uint8_t *b)
+{
+    int rc = storage_read(NVS_ID_PROVISION, b, PROVISION_BUNDLE_MAX);
+    if (rc < 0) {
+        return rc;
+    }
+    return (bundle_check(b, (size_t)rc) == 0) ? rc : -ENOENT;
+}
+
+int provision_get_identity(struct provision_identity *id)
+{
+    uint8_t b[PROVISION_BUNDLE_MAX];
+    int rc = bundle_load(b);
+    if (rc < 0) {
+        return -ENOENT;
+    }
+
+    memcpy(id->device_id, &b[B_DEVICE_ID], sizeof(id->device_id));
+    memcpy(id->server_ipv4, &b[B_IPV4], sizeof(id->server_ipv4));
+    id->server_port = sys_get_le16(&b[B_PORT]);
+    memcpy(id->device_key, &b[B_DEVICE_KEY], sizeof(id->device_key));
+    return 0;
+}
+
+int provision_get_config(uint8_t *entries, size_t cap)
+{
+    uint8_t b[PROVISION_BUNDLE_MAX];
+    if (bundle_load(b) < 0) {
+        return 0;
+    }
+
+    uint8_t count = b[B_CFG_COUNT];
+    size_t len = (size_t)count * SEAL_CFG_DOWNLINK_ENTRY;
+    if (len > cap) {
+        return 0;
+    }
+    memcpy(entries, &b[B_CFG], len);
+    return count;
+}
+
+#if defined(CONFIG_SEAL_PROVISIONING)
+
+#define PROVISION_READY_PERIOD_MS 250
+#define PROVISION_FRAME_TIMEOUT_MS 1000
+#define FRAME_HDR 4  // 'P' 'V' len u16
+#define FRAME_CRC 4
+
+static const struct device *const console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+/* Filled from the UART ISR; frozen once a complete frame is in */
+static uint8_t rx_frame[FRAME_HDR + PROVISION_BUNDLE_MAX + FRAME_CRC];
+static volatile size_t rx_len;
+static volatile size_t rx_need;
+static K_SEM_DEFINE(rx_done, 0, 1);
+
+static void rx_feed(uint8_t c)
+{
+    if (rx_need != 0 && rx_len == rx_need) {
+        return; // Previous frame not consumed yet
+    }
+    if ((rx_len == 0 && c != 'P') || (rx_len == 1 && c != 'V')) {
+        rx_len = 0;
+        return;
+    }
+
+    rx_frame[rx_len++] = c;
+
+    if (rx_len == FRAME_HDR) {
+        uint16_t len = sys_get_le16(&rx_frame[2]);
+        if (len > PROVISION_BUNDLE_MAX) {
+            rx_len = 0;
+            return;
+        }
+        rx_need = FRAME_HDR + len + FRAME_CRC;
+    } else if (rx_len == rx_need) {
+        k_sem_give(&rx_done);
+    }
+}
+
+static void uart_isr(const struct device *dev, void *user_data)
+{
+    ARG_UNUSED(user_data);
+    uint8_t c;
+
+    if (!uart_irq_update(dev)) {
+        return;
+    }
+    while (uart_irq_rx_ready(dev) && uart_fifo_read(dev, &c, 1) == 1) {
+        rx_feed(c);
+    }
+}
+
+static void rx_rearm(void)
+{
+    unsigned int key = irq_lock();
+    rx_len = 0;
+    rx_need = 0;
+    k_sem_reset(&rx_done);
+    irq_unlock(key);
+}
+
+static void console_puts(const char *s)
+{
+    while (*s) {
+        uart_poll_out(console, *s++);
+    }
+}
+
+static void console_put_hex_line(const char *prefix, const uint8_t *data, size_t len)
+{
+    char hex[2 * PROVISION_REPORT_SIZE + 1];
+
+    bin2hex(data, MIN(len, PROVISION_REPORT_SIZE), hex, sizeof(hex));
+    console_puts(prefix);
+    console_puts(hex);
+    console_puts("\r\n");
+}
+
+static int verify_signature(const uint8_t *b, size_t signed_len)
+{
+    uint8_t pub[65];
+    psa_key_id_t key_id;
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+    if (hex2bin(CONFIG_SEAL_PROVISION_PUBKEY, strlen(CONFIG_SEAL_PROVISION_PUBKEY),
+                pub, sizeof(pub)) != sizeof(pub)) {
+        LOG_ERR("No factory public key configured");
+        return -ENOKEY;
+    }
+
+    if (psa_crypto_init() != PSA_SUCCESS) {
+        return -EIO;
+    }
+
+    psa_set_key_type(&attr, PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_FAMILY_SECP_R1));
+    psa_set_key_bits(&attr, 256);
+    psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_VERIFY_MESSAGE);
+    psa_set_key_algorithm(&attr, PSA_ALG_ECDSA(PSA_ALG_SHA_256));
+
+    if (psa_import_key(&attr, pub, sizeof(pub), &key_id) != PSA_SUCCESS) {
+        return -EINVAL;
+    }
+
+    psa_status_t status = psa_verify_message(key_id, PSA_ALG_ECDSA(PSA_ALG_SHA_256),
+                                             b, signed_len, &b[signed_len], PROVISION_SIG_SIZE);
+    psa_destroy_key(key_id);
+    return (status == PSA_SUCCESS) ? 0 : -EBADMSG;
+}
+
+int provision_verify_tag(const uint8_t *data, size_t len, const uint8_t *ctx, size_t ctx_len,
+                         const uint8_t *tag)
+{
+    uint8_t b[PROVISION_BUNDLE_MAX];
+    if (bundle_load(b) < 0) {
+        return -ENOENT;
+    }
+
+    if (psa_crypto_init() != PSA_SUCCESS) {
+        return -EIO;
+    }
+
+    const psa_algorithm_t alg = PSA_ALG_TRUNCATED_MAC(PSA_ALG_HMAC(PSA_ALG_SHA_256),
+                                                      SEAL_CFG_DOWNLINK_TAG);
+    psa_key_id_t key_id;
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+    psa_set_key_type(&attr, PSA_KEY_TYPE_HMAC);
+    psa_set_key_bits(&attr, PROVISION_DEVICE_KEY_SIZE * 8);
+    psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_VERIFY_MESSAGE);
+    psa_set_key_algorithm(&attr, alg);
+
+    psa_status_t status = psa_import_key(&attr, &b[B_DEVICE_KEY], PROVISION_DEVICE_KEY_SIZE,
+                                         &key_id);
+    memset(b, 0, sizeof(b));
+    if (status != PSA_SUCCESS) {
+        return -EINVAL;
+    }
+
+    psa_mac_operation_t op = PSA_MAC_OPERATION_INIT;
+    status = psa_mac_verify_setup(&op, key_id, alg);
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_update(&op, data, len);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_update(&op, ctx, ctx_len);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_verify_finish(&op, tag, SEAL_CFG_DOWNLINK_TAG);
+    } else {
+        psa_mac_abort(&op);
+    }
+    psa_destroy_key(key_id);
+    return (status == PSA_SUCCESS) ? 0 : -EBADMSG;
+}
+
+static uint8_t self_test(const uint8_t *bundle, size_t len, uint16_t *timings)
+{
+    const struct device *sensor_bus = DEVICE_DT_GET(DT_NODELABEL(i2c2));
+    const struct device *pmic_bus = DEVICE_DT_GET(DT_NODELABEL(i2c1));
+    uint8_t failed = 0;
+    int64_t t;
+
+    t = k_uptime_get();
+    uint16_t counts;
+    if (veml6035_read_als(sensor_bus, &counts) < 0) {
+        failed |= PROVISION_TEST_SENSOR;
+    }
+    timings[0] = (uint16_t)(k_uptime_get() - t);
+
+    t = k_uptime_get();
+    if (npm1300_verify_bucks(pmic_bus) < 0) {
+        failed |= PROVISION_TEST_PMIC;
+    }
+    timings[1] = (uint16_t)(k_uptime_get() - t);
+
+    // Read the record back through NVS, not from the RAM copy
+    t = k_uptime_get();
+    uint8_t readback[PROVISION_BUNDLE_MAX];
+    int rc = storage_read(NVS_ID_PROVISION, readback, sizeof(readback));
+    if (rc != (int)len || memcmp(readback, bundle, len) != 0) {
+        failed |= PROVISION_TEST_FLASH;
+    }
+    timings[2] = (uint16_t)(k_uptime_get() - t);
+
+    return failed;
+}
+
+/*
+ * Report layout: version u8, result u8, failed tests u8, then u16 LE ms for
+ * signature check, NVS write, sensor, PMIC, flash readback and the whole
+ * frame-to-report time.
+ */
+static uint8_t handle_frame(const uint8_t *hw_id, uint8_t *report)
+{
+    int64_t start = k_uptime_get();
+    uint16_t t_verify = 0, t_store = 0;
+    uint16_t t_test[3] = {0};
+    uint8_t failed = 0;
+    uint8_t result;
+
+    size_t len = sys_get_le16(&rx_frame[2]);
+    const uint8_t *b = &rx_frame[FRAME_HDR];
+
+    if (crc32_ieee(b, len) != sys_get_le32(&b[len])) {
+        result = PROVISION_ERR_FRAME;
+        goto out;
+    }
+    if (bundle_check(b, len) < 0) {
+        result = PROVISION_ERR_BUNDLE;
+        goto out;
+    }
+    if (memcmp(&b[B_HW_ID], hw_id, PROVISION_HW_ID_SIZE) != 0) {
+        result = PROVISION_ERR_WRONG_UNIT;
+        goto out;
+    }
+
+    int64_t t = k_uptime_get();
+    int rc = verify_signature(b, bundle_signed_len(b[B_CFG_COUNT]));
+    t_verify = (uint16_t)(k_uptime_get() - t);
+    if (rc < 0) {
+        result = PROVISION_ERR_SIGNATURE;
+        goto out;
+    }
+
+    struct seal_config cfg;
+    if (config_from_entries(&cfg, &b[B_CFG], b[B_CFG_COUNT]) < 0) {
+        result = PROVISION_ERR_CONFIG;
+        goto out;
+    }
+
+    // Identity, endpoint, key and config land in one NVS entry: all or nothing
+    t = k_uptime_get();
+    rc = storage_write(NVS_ID_PROVISION, b, len);
+    t_store = (uint16_t)(k_uptime_get() - t);
+    if (rc < 0) {
+        result = PROVISION_ERR_STORE;
+        goto out;
+    }
+
+    failed = self_test(b, len, t_test);
+    result = failed ? PROVISION_ERR_SELF_TEST : PROVISION_OK;
+    if (failed) {
+        // The station keeps no key for a failed unit; it must not boot with this identity
+        rc = storage_delete(NVS_ID_PROVISION);
+        if (rc < 0) {
+            LOG_ERR("Failed to drop the provisioning record: %d", rc);
+        }
+    }
+
+out:
+    report[0] = PROVISION_PROTO_VERSION;
+    report[1] = result;
+    report[2] = failed;
+    sys_put_le16(t_verify, &report[3]);
+    sys_put_le16(t_store, &report[5]);
+    sys_put_le16(t_test[0], &report[7]);
+    sys_put_le16(t_test[1], &report[9]);
+    sys_put_le16(t_test[2], &report[11]);
+    sys_put_le16((uint16_t)(k_uptime_get() - start), &report[13]);
+    return result;
+}
+
+int provision_run(void)
+{
+    uint8_t b[PROVISION_BUNDLE_MAX];
+    if (bundle_load(b) >= 0) {
+        return 0;
+    }
+    if (!device_is_ready(console)) {
+        return -ENODEV;
+    }
+
+    uint8_t hw_id[PROVISION_HW_ID_SIZE] = {0};
+    hwinfo_get_device_id(hw_id, sizeof(hw_id));
+
+    char ready[sizeof("#PV:READY 255 ") + 2 * PROVISION_HW_ID_SIZE + 2];
+    char hw_hex[2 * PROVISION_HW_ID_SIZE + 1];
+    bin2hex(hw_id, sizeof(hw_id), hw_hex, sizeof(hw_hex));
+    snprintk(ready, sizeof(ready), "#PV:READY %u %s\r\n", PROVISION_PROTO_VERSION, hw_hex);
+
+    rx_rearm();
+    uart_irq_callback_user_data_set(console, uart_isr, NULL);
+    uart_irq_rx_enable(console);
+
+    int ret = -ETIMEDOUT;
+    int64_t deadline = k_uptime_get() + CONFIG_SEAL_PROVISION_WINDOW_MS;
+
+    while (k_uptime_get() < deadline) {
+        watchdog_mgr_kick();
+
+        // Stop announcing once a frame is on its way
+        if (rx_len == 0) {
+            console_puts(ready);
+        }
+        if (k_sem_take(&rx_done, K_MSEC(rx_len ? PROVISION_FRAME_TIMEOUT_MS
+                                                : PROVISION_READY_PERIOD_MS)) != 0) {
+            if (rx_len != 0) {
+                rx_rearm(); // Stalled mid-frame
+            }
+            continue;
+        }
+
+        uint8_t report[PROVISION_REPORT_SIZE];
+        uint8_t result = handle_frame(hw_id, report);
+        console_put_hex_line("#PV:RESULT ", report, sizeof(report));
+
+        if (result == PROVISION_OK) {
+            LOG_INF("Provisioned in %u ms", sys_get_le16(&report[13]));
+            ret = 0;
+            break;
+        }
+
+        // Let the station retry within a fresh window
+        LOG_WRN("Provisioning failed: %u (tests 0x%02x)", result, report[2]);
+        deadline = k_uptime_get() + CONFIG_SEAL_PROVISION_WINDOW_MS;
+        rx_rearm();
+    }
+
+    uart_irq_rx_disable(console);
+    return ret;
+}
+
+#else
+
+int provision_run(void)
+{
+    return -ENOTSUP;
+}
+
+int provision_verify_tag(const uint8_t *data, size_t len, const uint8_t *ctx, size_t ctx_len,
+                         const uint8_t *tag)
+{
+    return -ENOTSUP;
+}
+
+#endif
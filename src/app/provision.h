@@ -0,0 +1,101 @@
+#ifndef PROVISION_H
+#define PROVISION_H
+
+#include "config.h"
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/**
+ * @file provision.h
+ * @brief Factory provisioning over the console UART.
+ *
+ * An unprovisioned unit announces itself on the console; the line station
+ * answers with one signed bundle (identity, server endpoint, device key,
+ * config overrides). The unit verifies the signature, stores the bundle as
+ * a single NVS record, runs a timed self-test and prints a compact report.
+ *
+ * Console protocol:
+ *   device: "#PV:READY <proto> <hw id hex>"    every PROVISION_READY_PERIOD_MS
+ *   host:   'P' 'V' len u16 LE, bundle[len], crc32 LE over the bundle
+ *   device: "#PV:RESULT <report hex>"          (see struct provision_report)
+ *
+ * Bundle (little endian), signed with ECDSA P-256/SHA-256 by the factory key:
+ *   version u8, flags u8, hw_id[8], device_id[16], server ipv4[4], port u16,
+ *   device_key[32], cfg_count u8, cfg_count x (key u8, value u32),
+ *   signature r||s [64] over everything before it.
+ *
+ * The device key is shared with the ingest server only, which uses it to
+ * authenticate config downlinks (see provision_verify_tag()).
+ */
+
+#define PROVISION_PROTO_VERSION  1
+#define PROVISION_BUNDLE_VERSION 1
+#define PROVISION_MAX_CFG        8
+#define PROVISION_HW_ID_SIZE     8
+#define PROVISION_DEVICE_KEY_SIZE 32
+#define PROVISION_SIG_SIZE       64
+#define PROVISION_BUNDLE_FIXED   65 // Everything before the config entries
+#define PROVISION_BUNDLE_MAX     (PROVISION_BUNDLE_FIXED + PROVISION_MAX_CFG * SEAL_CFG_DOWNLINK_ENTRY + \
+                                  PROVISION_SIG_SIZE)
+
+/* Report result codes */
+enum provision_result {
+    PROVISION_OK = 0,
+    PROVISION_ERR_FRAME = 1,     // Bad length or CRC
+    PROVISION_ERR_BUNDLE = 2,    // Unknown version or malformed contents
+    PROVISION_ERR_SIGNATURE = 3,
+    PROVISION_ERR_WRONG_UNIT = 4, // Bundle bound to another hardware id
+    PROVISION_ERR_CONFIG = 5,    // Config overrides out of range
+    PROVISION_ERR_STORE = 6,
+    PROVISION_ERR_SELF_TEST = 7,
+};
+
+/* Self-test failure bits */
+#define PROVISION_TEST_SENSOR (1 << 0)
+#define PROVISION_TEST_PMIC   (1 << 1)
+#define PROVISION_TEST_FLASH  (1 << 2)
+
+/* Encoded report: version, result, test bits, then u16 LE ms timings */
+#define PROVISION_REPORT_SIZE 15
+
+struct provision_identity {
+    uint8_t device_id[16];
+    uint8_t server_ipv4[4];
+    uint16_t server_port;
+    uint8_t device_key[PROVISION_DEVICE_KEY_SIZE];
+};
+
+/**
+ * @brief Run a provisioning session on the console, unless already provisioned.
+ *
+ * Returns once a bundle has been stored and passed self-test, or when no
+ * line station answered within CONFIG_SEAL_PROVISION_WINDOW_MS.
+ *
+ * @return 0 if provisioned (now or earlier), -ETIMEDOUT if no station answered.
+ */
+int provision_run(void);
+
+/**
+ * @brief Identity from the stored bundle.
+ * @return 0 on success, -ENOENT if the unit was never provisioned.
+ */
+int provision_get_identity(struct provision_identity *id);
+
+/**
+ * @brief Check a truncated HMAC-SHA256 tag, keyed with the device key, over
+ *        @p data followed by @p ctx.
+ *
+ * @param tag SEAL_CFG_DOWNLINK_TAG bytes.
+ * @return 0 if the tag matches, -ENOENT if the unit was never provisioned,
+ *         -EBADMSG if it does not match, -ENOTSUP without provisioning support.
+ */
+int provision_verify_tag(const uint8_t *data, size_t len, const uint8_t *ctx, size_t ctx_len,
+                         const uint8_t *tag);
+
+/**
+ * @brief Config overrides from the stored bundle, as [key u8][value u32 LE] entries.
+ * @return Number of entries, 0 if none or not provisioned.
+ */
+int provision_get_config(uint8_t *entries, size_t cap);
+
+#endif
@@ -0,0 +1,89 @@
+#include "retained.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <hal/nrf_vmc.h> // RAM retention in System OFF
+
+LOG_MODULE_REGISTER(retained);
+
+/* nRF9160 RAM: 8 blocks of 32 KiB starting at 0x20000000 */
+#define RAM_BASE_ADDR   0x20000000UL
+#define RAM_BLOCK_SIZE  0x8000UL
+
+/* Linker symbols delimiting the retained region (retained.ld) */
+extern uint8_t __retained_start[];
+extern uint8_t __retained_end[];
+
+static struct retained_state state __retained;
+
+static uint32_t retained_crc(void)
+{
+    return crc32_ieee((const uint8_t *)&state, offsetof(struct retained_state, crc));
+}
+
+bool retained_init(void)
+{
+    bool valid = (state.magic == RETAINED_MAGIC) &&
+                 (state.version == RETAINED_VERSION) &&
+                 (state.crc == retained_crc());
+
+    if (!valid) {
+        LOG_WRN("Retained state invalid (power loss?), falling back to flash");
+        return false;
+    }
+
+    state.boot_count++;
+    retained_update();
+    return true;
+}
+
+struct retained_state *retained_get(void)
+{
+    return &state;
+}
+
+void retained_reset(uint32_t flags, uint8_t fsm_state)
+{
+    memset(&state, 0, sizeof(state));
+    state.magic = RETAINED_MAGIC;
+    state.version = RETAINED_VERSION;
+    state.flags = flags;
+    state.fsm_state = fsm_state;
+    state.boot_count = 1;
+    retained_update();
+}
+
+void retained_update(void)
+{
+    state.crc = retained_crc();
+}
+
+void retained_invalidate(void)
+{
+    state.magic = 0;
+    state.crc = 0;
+}
+
+void retained_prepare_off(void)
+{
+    if (state.magic == RETAINED_MAGIC) {
+        state.ledger.active_ms += (uint32_t)k_uptime_get();
+        retained_update();
+    }
+
+    // Keep every RAM block spanned by the retained region powered in System OFF
+    uintptr_t start = (uintptr_t)__retained_start;
+    uintptr_t end = (uintptr_t)__retained_end;
+
+    if (end <= start) {
+        return;
+    }
+
+    for (uintptr_t addr = start & ~(RAM_BLOCK_SIZE - 1); addr < end; addr += RAM_BLOCK_SIZE) {
+        uint8_t block = (uint8_t)((addr - RAM_BASE_ADDR) / RAM_BLOCK_SIZE);
+        nrf_vmc_ram_block_retention_set(NRF_VMC, block, NRF_VMC_RETENTION_ALL);
+    }
+}
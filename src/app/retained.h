@@ -0,0 +1,72 @@
+#ifndef RETAINED_H
+#define RETAINED_H
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+/**
+ * @file retained.h
+ * @brief State block kept alive in retained RAM across System OFF.
+ *
+ * The block is checksummed; flash (NVS) is only consulted when it is
+ * invalid, e.g. after a battery pull or a factory reset.
+ */
+
+/* Place a variable in the retained RAM region (see retained.ld) */
+#define __retained __attribute__((section(".retained_ram"))) __aligned(4)
+
+#define RETAINED_MAGIC   0x5EA1B10C
+#define RETAINED_VERSION 1
+
+struct retained_ledger {
+    uint32_t active_ms;    // Accumulated System ON time
+    uint32_t modem_on_ms;  // Accumulated time with the modem powered
+    uint32_t tx_attempts;  // Accumulated uplink attempts
+};
+
+struct retained_state {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t fsm_state;
+    uint16_t last_lux;
+    uint32_t flags;        // Mirror of the NVS state flags
+    uint32_t boot_count;
+    uint32_t wake_count;
+    uint32_t seq_num;      // Alert sequence (NVS_ID_EVENT_SEQ), sent as PAYLOAD_TLV_EVENT
+    struct retained_ledger ledger;
+    uint32_t crc;          // CRC32 over all preceding fields
+};
+
+/**
+ * @brief Validate the retained block and count this boot.
+ * @return true if the block was valid and can be trusted.
+ */
+bool retained_init(void);
+
+/**
+ * @brief Access the retained block. Call retained_update() after changes.
+ */
+struct retained_state *retained_get(void);
+
+/**
+ * @brief Re-initialise the block from a known set of flags (e.g. read from NVS).
+ */
+void retained_reset(uint32_t flags, uint8_t fsm_state);
+
+/**
+ * @brief Recompute the checksum after modifying the block.
+ */
+void retained_update(void);
+
+/**
+ * @brief Mark the block invalid so the next boot falls back to flash.
+ */
+void retained_invalidate(void);
+
+/**
+ * @brief Close the energy ledger and keep the retained RAM powered in System OFF.
+ * Must be called right before entering System OFF.
+ */
+void retained_prepare_off(void);
+
+#endif
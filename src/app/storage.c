@@ -9,11 +9,27 @@ LOG_MODULE_REGISTER(storage);
 static struct nvs_fs fs;
 #define NVS_PARTITION		storage_partition 
 
+static bool mounted = false;
+static uint32_t access_count = 0;
+
+// Mount on first use so the retained-RAM wake path never touches flash
+static int storage_ensure_mounted(void)
+{
+    if (mounted) {
+        return 0;
+    }
+    return storage_init();
+}
+
 int storage_init(void)
 {
     int rc;
     struct flash_pages_info info;
 
+    if (mounted) {
+        return 0;
+    }
+
     /* Define the Flash device and offset from the Device Tree Partition */
     fs.flash_device = FIXED_PARTITION_DEVICE(NVS_PARTITION);
     if (!device_is_ready(fs.flash_device)) {
@@ -39,22 +55,48 @@ int storage_init(void)
         return rc;
     }
 
+    access_count++;
+    mounted = true;
     return 0;
 }
 
 int storage_set_flag(uint32_t flag)
 {
     uint32_t current_flags = 0;
-    storage_get_flags(&current_flags);
+    int rc = storage_get_flags(&current_flags);
+    if (rc < 0) {
+        return rc;
+    }
     
     current_flags |= flag;
     
+    access_count++;
+    return nvs_write(&fs, NVS_ID_STATE_FLAGS, &current_flags, sizeof(current_flags));
+}
+
+int storage_clear_flag(uint32_t flag)
+{
+    uint32_t current_flags = 0;
+    int rc = storage_get_flags(&current_flags);
+    if (rc < 0) {
+        return rc;
+    }
+
+    current_flags &= ~flag;
+
+    access_count++;
     return nvs_write(&fs, NVS_ID_STATE_FLAGS, &current_flags, sizeof(current_flags));
 }
 
 int storage_get_flags(uint32_t *flags)
 {
-    int rc = nvs_read(&fs, NVS_ID_STATE_FLAGS, flags, sizeof(uint32_t));
+    int rc = storage_ensure_mounted();
+    if (rc < 0) {
+        return rc;
+    }
+
+    access_count++;
+    rc = nvs_read(&fs, NVS_ID_STATE_FLAGS, flags, sizeof(uint32_t));
     if (rc > 0) {
         // Success
         return 0; 
@@ -68,8 +110,14 @@ int storage_get_flags(uint32_t *flags)
 
 int storage_reset(void)
 {
+    int rc = storage_ensure_mounted();
+    if (rc < 0) {
+        return rc;
+    }
+
     // Delete the NVS ID to wipe all flags
-    int rc = nvs_delete(&fs, NVS_ID_STATE_FLAGS);
+    access_count++;
+    rc = nvs_delete(&fs, NVS_ID_STATE_FLAGS);
     if (rc == 0) {
         LOG_INF("*** STORAGE FACTORY RESET ***");
     } else if (rc == -ENOENT) {
@@ -80,3 +128,44 @@ int storage_reset(void)
     }
     return rc;
 }
+
+int storage_read(uint16_t id, void *data, size_t len)
+{
+    int rc = storage_ensure_mounted();
+    if (rc < 0) {
+        return rc;
+    }
+
+    access_count++;
+    return nvs_read(&fs, id, data, len);
+}
+
+int storage_write(uint16_t id, const void *data, size_t len)
+{
+    int rc = storage_ensure_mounted();
+    if (rc < 0) {
+        return rc;
+    }
+
+    access_count++;
+    rc = nvs_write(&fs, id, data, len);
+    // nvs_write returns 0 when the data is unchanged
+    return (rc < 0) ? rc : 0;
+}
+
+int storage_delete(uint16_t id)
+{
+    int rc = storage_ensure_mounted();
+    if (rc < 0) {
+        return rc;
+    }
+
+    access_count++;
+    rc = nvs_delete(&fs, id);
+    return (rc == -ENOENT) ? 0 : rc;
+}
+
+uint32_t storage_get_access_count(void)
+{
+    return access_count;
+}
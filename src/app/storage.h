@@ -2,18 +2,33 @@
 #define STORAGE_H
 
 #include <zephyr/types.h>
+#include <stddef.h>
 
 /* NVS IDs */
 #define NVS_ID_STATE_FLAGS 1
+#define NVS_ID_CONFIG      2 // Active config blob (config.h)
+#define NVS_ID_CONFIG_PREV 3 // Last known good config blob, for rollback
+#define NVS_ID_PROVISION   4 // Signed factory bundle (provision.h)
+#define NVS_ID_ENDPOINT    5 // Resolved server addresses and health (endpoint.h)
+#define NVS_ID_EVENT_SEQ   6 // Alert counter, advanced once per trigger; survives factory reset
 
 /* Flags */
 #define FLAG_PROVISIONED  (1 << 0)
 #define FLAG_TRIGGERED    (1 << 1)
 #define FLAG_TERMINATED   (1 << 2)
 
+/**
+ * @brief Mount NVS. Safe to call repeatedly; the other calls mount on demand.
+ * @return 0 on success.
+ */
 int storage_init(void);
 
 int storage_set_flag(uint32_t flag);
+/**
+ * @brief Clear state flags, e.g. FLAG_TRIGGERED once a multi-event seal re-arms.
+ * @return 0 on success.
+ */
+int storage_clear_flag(uint32_t flag);
 int storage_get_flags(uint32_t *flags);
 /**
  * @brief Wipes the state flags from NVS (Factory Reset).
@@ -21,4 +36,27 @@ int storage_get_flags(uint32_t *flags);
  */
 int storage_reset(void);
 
+/**
+ * @brief Read a raw NVS record.
+ * @return Number of bytes stored for @p id, or negative errno (-ENOENT if absent).
+ */
+int storage_read(uint16_t id, void *data, size_t len);
+
+/**
+ * @brief Write a raw NVS record (a single atomic NVS entry).
+ * @return 0 on success.
+ */
+int storage_write(uint16_t id, const void *data, size_t len);
+
+/**
+ * @brief Delete a raw NVS record.
+ * @return 0 on success, including when @p id was absent.
+ */
+int storage_delete(uint16_t id);
+
+/**
+ * @brief Number of flash operations (mount, read, write, delete) since boot.
+ */
+uint32_t storage_get_access_count(void);
+
 #endif
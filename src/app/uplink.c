@@ -0,0 +1,70 @@
+#include "uplink.h"
+#include "uplink_transport.h"
+#include <zephyr/logging/log.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(uplink);
+
+int uplink_parse_ipv4(const char *str, uint8_t ipv4[4])
+{
+    for (int i = 0; i < 4; i++) {
+        uint32_t octet = 0;
+        int digits = 0;
+
+        while (*str >= '0' && *str <= '9') {
+            octet = octet * 10 + (uint32_t)(*str++ - '0');
+            if (++digits > 3 || octet > 255) {
+                return -EINVAL;
+            }
+        }
+        if (digits == 0 || *str != ((i < 3) ? '.' : '\0')) {
+            return -EINVAL;
+        }
+        ipv4[i] = (uint8_t)octet;
+        str++;
+    }
+    return 0;
+}
+
+int uplink_send(const struct uplink_endpoint *ep, const uint8_t *tx, size_t tx_len,
+                uint8_t *rx, size_t rx_cap, uint16_t timeout_s, uint32_t reply_wait_ms)
+{
+    uint32_t timeout_ms = (uint32_t)timeout_s * 1000U;
+
+    int fd = uplink_sock_open();
+    if (fd < 0) {
+        LOG_ERR("Socket fail: %d", fd);
+        return fd;
+    }
+
+    int err = uplink_sock_set_timeouts(fd, timeout_ms, timeout_ms);
+    if (err < 0) {
+        LOG_WRN("Socket timeouts not set: %d", err);
+    }
+
+    err = uplink_sock_connect(fd, ep);
+    if (err < 0) {
+        LOG_ERR("Connect fail: %d", err);
+        uplink_sock_close(fd);
+        return err;
+    }
+
+    err = uplink_sock_send(fd, tx, tx_len);
+    if (err < 0) {
+        LOG_ERR("Send fail: %d", err);
+        uplink_sock_close(fd);
+        return err;
+    }
+
+    int rx_len = 0;
+    if (rx != NULL && reply_wait_ms > 0) {
+        uplink_sock_set_timeouts(fd, timeout_ms, reply_wait_ms);
+        rx_len = uplink_sock_recv(fd, rx, rx_cap);
+        if (rx_len < 0) {
+            rx_len = 0; // No reply is not a send failure
+        }
+    }
+
+    uplink_sock_close(fd);
+    return rx_len;
+}
@@ -0,0 +1,45 @@
+#ifndef UPLINK_H
+#define UPLINK_H
+
+#include <zephyr/types.h>
+#include <stddef.h>
+
+/**
+ * @file uplink.h
+ * @brief One-shot UDP datagram exchange with the ingest server.
+ *
+ * uplink.c implements it on top of the socket primitives in
+ * uplink_transport.h. Two transports provide those, selected by Kconfig:
+ * the Zephyr socket offload layer (uplink_posix.c) and the modem's
+ * nrf_socket API directly (uplink_nrf.c).
+ */
+
+struct uplink_endpoint {
+    uint8_t ipv4[4]; // Network byte order
+    uint16_t port;
+};
+
+/**
+ * @brief Parse a dotted-quad IPv4 literal.
+ * @return 0 on success, -EINVAL if @p str is not a valid literal.
+ */
+int uplink_parse_ipv4(const char *str, uint8_t ipv4[4]);
+
+/**
+ * @brief Send one datagram and optionally wait for a reply on the same socket.
+ *
+ * @param ep            Server endpoint.
+ * @param tx            Datagram to send.
+ * @param tx_len        Length of @p tx.
+ * @param rx            Reply buffer, or NULL to skip waiting for a reply.
+ * @param rx_cap        Capacity of @p rx.
+ * @param timeout_s     Send timeout (also bounds connect).
+ * @param reply_wait_ms How long to wait for a reply after a successful send.
+ *
+ * @return Number of reply bytes (0 if none arrived), or negative errno if the
+ *         datagram could not be sent.
+ */
+int uplink_send(const struct uplink_endpoint *ep, const uint8_t *tx, size_t tx_len,
+                uint8_t *rx, size_t rx_cap, uint16_t timeout_s, uint32_t reply_wait_ms);
+
+#endif
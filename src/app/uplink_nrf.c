@@ -0,0 +1,64 @@
+#include "uplink_transport.h"
+#include <nrf_socket.h>
+#include <errno.h>
+#include <string.h>
+
+/*
+ * Talks to the modem through nrf_socket directly, so the image needs
+ * neither CONFIG_NET_SOCKETS, the socket offload layer nor CONFIG_POSIX_API.
+ * nrf_modem_lib maps modem errors onto errno.
+ */
+
+static struct nrf_timeval ms_to_timeval(uint32_t ms)
+{
+    return (struct nrf_timeval){
+        .tv_sec = ms / 1000,
+        .tv_usec = (ms % 1000) * 1000,
+    };
+}
+
+int uplink_sock_open(void)
+{
+    int fd = nrf_socket(NRF_AF_INET, NRF_SOCK_DGRAM, NRF_IPPROTO_UDP);
+    return (fd < 0) ? -errno : fd;
+}
+
+int uplink_sock_set_timeouts(int fd, uint32_t send_ms, uint32_t recv_ms)
+{
+    struct nrf_timeval snd = ms_to_timeval(send_ms);
+    struct nrf_timeval rcv = ms_to_timeval(recv_ms);
+
+    if (nrf_setsockopt(fd, NRF_SOL_SOCKET, NRF_SO_SNDTIMEO, &snd, sizeof(snd)) < 0 ||
+        nrf_setsockopt(fd, NRF_SOL_SOCKET, NRF_SO_RCVTIMEO, &rcv, sizeof(rcv)) < 0) {
+        return -errno;
+    }
+    return 0;
+}
+
+int uplink_sock_connect(int fd, const struct uplink_endpoint *ep)
+{
+    struct nrf_sockaddr_in server = {
+        .sin_family = NRF_AF_INET,
+        .sin_port = nrf_htons(ep->port),
+    };
+    memcpy(&server.sin_addr, ep->ipv4, sizeof(ep->ipv4));
+
+    return (nrf_connect(fd, (struct nrf_sockaddr *)&server, sizeof(server)) < 0) ? -errno : 0;
+}
+
+int uplink_sock_send(int fd, const uint8_t *buf, size_t len)
+{
+    ssize_t n = nrf_send(fd, buf, len, 0);
+    return (n < 0) ? -errno : (int)n;
+}
+
+int uplink_sock_recv(int fd, uint8_t *buf, size_t cap)
+{
+    ssize_t n = nrf_recv(fd, buf, cap, 0);
+    return (n < 0) ? -errno : (int)n;
+}
+
+void uplink_sock_close(int fd)
+{
+    nrf_close(fd);
+}
@@ -0,0 +1,60 @@
+#include "uplink_transport.h"
+#include <zephyr/net/socket.h>
+#include <zephyr/posix/unistd.h>
+#include <zephyr/posix/sys/socket.h>
+#include <errno.h>
+#include <string.h>
+
+static struct timeval ms_to_timeval(uint32_t ms)
+{
+    return (struct timeval){
+        .tv_sec = ms / 1000,
+        .tv_usec = (ms % 1000) * 1000,
+    };
+}
+
+int uplink_sock_open(void)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    return (fd < 0) ? -errno : fd;
+}
+
+int uplink_sock_set_timeouts(int fd, uint32_t send_ms, uint32_t recv_ms)
+{
+    struct timeval snd = ms_to_timeval(send_ms);
+    struct timeval rcv = ms_to_timeval(recv_ms);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &snd, sizeof(snd)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &rcv, sizeof(rcv)) < 0) {
+        return -errno;
+    }
+    return 0;
+}
+
+int uplink_sock_connect(int fd, const struct uplink_endpoint *ep)
+{
+    struct sockaddr_in server = {
+        .sin_family = AF_INET,
+        .sin_port = htons(ep->port),
+    };
+    memcpy(&server.sin_addr, ep->ipv4, sizeof(ep->ipv4));
+
+    return (connect(fd, (struct sockaddr *)&server, sizeof(server)) < 0) ? -errno : 0;
+}
+
+int uplink_sock_send(int fd, const uint8_t *buf, size_t len)
+{
+    ssize_t n = send(fd, buf, len, 0);
+    return (n < 0) ? -errno : (int)n;
+}
+
+int uplink_sock_recv(int fd, uint8_t *buf, size_t cap)
+{
+    ssize_t n = recv(fd, buf, cap, 0);
+    return (n < 0) ? -errno : (int)n;
+}
+
+void uplink_sock_close(int fd)
+{
+    close(fd);
+}
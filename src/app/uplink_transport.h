@@ -0,0 +1,28 @@
+#ifndef UPLINK_TRANSPORT_H
+#define UPLINK_TRANSPORT_H
+
+#include "uplink.h"
+
+/*
+ * Socket primitives behind uplink_send(). Each transport (uplink_posix.c,
+ * uplink_nrf.c) maps them onto its socket API; the control flow, timeouts
+ * and error handling live in uplink.c only. All return a negative errno on
+ * failure.
+ */
+
+/* Open a UDP socket, returning its descriptor */
+int uplink_sock_open(void);
+
+/* Set the send and receive timeouts */
+int uplink_sock_set_timeouts(int fd, uint32_t send_ms, uint32_t recv_ms);
+
+int uplink_sock_connect(int fd, const struct uplink_endpoint *ep);
+
+int uplink_sock_send(int fd, const uint8_t *buf, size_t len);
+
+/* Returns the number of bytes received */
+int uplink_sock_recv(int fd, uint8_t *buf, size_t cap);
+
+void uplink_sock_close(int fd);
+
+#endif
@@ -1,13 +1,175 @@
 #include "watchdog_mgr.h"
+#include "retained.h"
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/watchdog.h>
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <cmsis_core.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(watchdog_mgr);
 
 static const struct device *wdt = DEVICE_DT_GET(DT_ALIAS(watchdog0));
 static int wdt_channel_id;
+static const struct device *const console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+
+/* Upper bound on waiting for deferred logs before the console goes down */
+#define LOG_DRAIN_MAX_MS 20
+
+#define STALL_MAGIC 0x53544C4C // "STLL"
+
+/* Why the record was captured */
+#define STALL_REASON_NONE     0
+#define STALL_REASON_WATCHDOG 1 // Pre-timeout; the SoC reset right after
+#define STALL_REASON_OVERRUN  2 // Stage deadline missed, no reset (yet)
+
+struct stall_record {
+    uint32_t magic;
+    uint8_t reason;
+    uint8_t fsm_state;
+    uint8_t stage;
+    uint8_t overruns;           // Deadline misses since the last delivered record
+    uint32_t uptime_ms;
+    uint32_t stage_elapsed_ms;
+    uint32_t since_kick_ms;
+    uint32_t pc;                // Main thread, from its exception frame
+    uint32_t lr;
+    uint16_t stack_unused[2];   // Main, system workqueue; last sample
+    uint32_t crc;
+};
+
+static struct stall_record stall __retained;
+static uint32_t stall_reported_crc;
+
+static k_tid_t main_thread;
+static volatile uint8_t stage_current = WDT_STAGE_IDLE;
+static volatile int64_t stage_start_ms;
+static volatile int64_t last_kick_ms;
+static uint16_t stack_unused[2];
+
+static void stage_expired(struct k_timer *timer);
+K_TIMER_DEFINE(stage_timer, stage_expired, NULL);
+
+static uint32_t stall_crc(void)
+{
+    return crc32_ieee((const uint8_t *)&stall, offsetof(struct stall_record, crc));
+}
+
+static bool stall_is_valid(void)
+{
+    return (stall.magic == STALL_MAGIC) && (stall.crc == stall_crc()) &&
+           (stall.reason != STALL_REASON_NONE);
+}
+
+// Stack scans stop at the first used byte, so this is cheap; never done from the pre-timeout ISR
+static void sample_stacks(void)
+{
+    const struct k_thread *threads[] = { main_thread, &k_sys_work_q.thread };
+    size_t unused;
+
+    for (size_t i = 0; i < ARRAY_SIZE(threads); i++) {
+        if (threads[i] != NULL &&
+            k_thread_stack_space_get(threads[i], &unused) == 0) {
+            stack_unused[i] = (uint16_t)MIN(unused, UINT16_MAX);
+        }
+    }
+}
+
+/*
+ * Where the main thread is: PC and LR from the hardware-stacked frame.
+ * If the ISR interrupted main, the frame is at PSP; otherwise main is
+ * switched out and its PSP was saved on the context switch. A blocked
+ * thread shows the swap code in PC, with the caller in LR.
+ */
+static void main_thread_frame(uint32_t *pc, uint32_t *lr)
+{
+    uintptr_t psp;
+
+    if (k_current_get() == main_thread) {
+        psp = __get_PSP();
+    } else {
+        psp = main_thread->callee_saved.psp;
+    }
+
+    uintptr_t lo = main_thread->stack_info.start;
+    uintptr_t hi = lo + main_thread->stack_info.size;
+    if (psp < lo || psp + 8 * sizeof(uint32_t) > hi) {
+        *pc = 0;
+        *lr = 0;
+        return;
+    }
+
+    const uint32_t *frame = (const uint32_t *)psp; // r0-r3, r12, lr, pc, xpsr
+    *lr = frame[5];
+    *pc = frame[6];
+}
+
+static void stall_capture(uint8_t reason)
+{
+    int64_t now = k_uptime_get();
+
+    stall.magic = STALL_MAGIC;
+    stall.reason = reason;
+    stall.fsm_state = retained_get()->fsm_state;
+    stall.stage = stage_current;
+    stall.uptime_ms = (uint32_t)now;
+    stall.stage_elapsed_ms = (stage_current != WDT_STAGE_IDLE) ? (uint32_t)(now - stage_start_ms) : 0;
+    stall.since_kick_ms = (uint32_t)(now - last_kick_ms);
+    main_thread_frame(&stall.pc, &stall.lr);
+    memcpy(stall.stack_unused, stack_unused, sizeof(stall.stack_unused));
+    stall.crc = stall_crc();
+}
+
+/*
+ * Pre-timeout: the nRF WDT resets the SoC two 32 kHz cycles (~61 us) after
+ * this runs, so only copy what is already at hand into retained RAM.
+ */
+static void wdt_pre_timeout(const struct device *dev, int channel_id)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channel_id);
+
+    uint8_t overruns = stall_is_valid() ? stall.overruns : 0;
+    stall_capture(STALL_REASON_WATCHDOG);
+    stall.overruns = overruns;
+    stall.crc = stall_crc();
+}
+
+static void stage_expired(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    bool valid = stall_is_valid();
+    uint8_t overruns = valid ? stall.overruns : 0;
+
+    // A record that ended in a reset is more useful than a later overrun
+    if (!valid || stall.reason != STALL_REASON_WATCHDOG) {
+        stall_capture(STALL_REASON_OVERRUN);
+    }
+    stall.overruns = (overruns < UINT8_MAX) ? overruns + 1 : overruns;
+    stall.crc = stall_crc();
+
+    LOG_WRN("Stage %u over its deadline (%u ms, pc 0x%08x lr 0x%08x)",
+            stage_current, (uint32_t)(k_uptime_get() - stage_start_ms), stall.pc, stall.lr);
+}
 
 int watchdog_mgr_init(uint32_t timeout_ms)
 {
+    main_thread = k_current_get();
+    last_kick_ms = k_uptime_get();
+
+    if (stall_is_valid()) {
+        LOG_WRN("Stall record: reason %u, state %u, stage %u (%u ms), pc 0x%08x lr 0x%08x",
+                stall.reason, stall.fsm_state, stall.stage, stall.stage_elapsed_ms,
+                stall.pc, stall.lr);
+    } else {
+        memset(&stall, 0, sizeof(stall));
+    }
+
     if (!device_is_ready(wdt)) {
         return -1;
     }
@@ -15,7 +177,7 @@ int watchdog_mgr_init(uint32_t timeout_ms)
     struct wdt_timeout_cfg wdt_config = {
         .window.min = 0,
         .window.max = timeout_ms,
-        .callback = NULL, // Reset on expiration
+        .callback = wdt_pre_timeout, // Capture a stall record, then reset
         .flags = WDT_FLAG_RESET_SOC,
     };
 
@@ -30,4 +192,87 @@ int watchdog_mgr_init(uint32_t timeout_ms)
 void watchdog_mgr_kick(void)
 {
     wdt_feed(wdt, wdt_channel_id);
+    last_kick_ms = k_uptime_get();
+    sample_stacks();
+}
+
+void watchdog_mgr_idle_enter(void)
+{
+    if (!IS_ENABLED(CONFIG_SEAL_CONSOLE_PM)) {
+        return;
+    }
+    if (IS_ENABLED(CONFIG_LOG_MODE_DEFERRED)) {
+        for (int i = 0; i < LOG_DRAIN_MAX_MS && log_data_pending(); i++) {
+            k_sleep(K_MSEC(1));
+        }
+    }
+    pm_device_runtime_put(console);
+}
+
+void watchdog_mgr_idle_exit(void)
+{
+    if (IS_ENABLED(CONFIG_SEAL_CONSOLE_PM)) {
+        pm_device_runtime_get(console);
+    }
+}
+
+void watchdog_mgr_sleep(k_timeout_t timeout)
+{
+    watchdog_mgr_kick();
+    watchdog_mgr_idle_enter();
+    k_sleep(timeout);
+    watchdog_mgr_idle_exit();
+}
+
+void watchdog_mgr_sleep_s(uint32_t seconds)
+{
+    for (uint32_t waited = 0; waited < seconds; waited += WATCHDOG_SLEEP_CHUNK_S) {
+        watchdog_mgr_sleep(K_SECONDS(MIN(WATCHDOG_SLEEP_CHUNK_S, seconds - waited)));
+    }
+}
+
+void watchdog_mgr_stage_begin(enum wdt_stage stage, uint32_t deadline_ms)
+{
+    stage_start_ms = k_uptime_get();
+    stage_current = (uint8_t)stage;
+    k_timer_start(&stage_timer, K_MSEC(deadline_ms), K_NO_WAIT);
+}
+
+void watchdog_mgr_stage_end(void)
+{
+    k_timer_stop(&stage_timer);
+    stage_current = WDT_STAGE_IDLE;
+    sample_stacks();
+}
+
+size_t watchdog_mgr_stall_encode(uint8_t *out, size_t cap)
+{
+    if (cap < WATCHDOG_STALL_TLV_SIZE || !stall_is_valid()) {
+        return 0;
+    }
+
+    out[0] = stall.reason;
+    out[1] = stall.fsm_state;
+    out[2] = stall.stage;
+    out[3] = stall.overruns;
+    sys_put_le32(stall.uptime_ms, &out[4]);
+    sys_put_le32(stall.stage_elapsed_ms, &out[8]);
+    sys_put_le32(stall.since_kick_ms, &out[12]);
+    sys_put_le32(stall.pc, &out[16]);
+    sys_put_le32(stall.lr, &out[20]);
+    sys_put_le16(stall.stack_unused[0], &out[24]);
+    sys_put_le16(stall.stack_unused[1], &out[26]);
+
+    stall_reported_crc = stall.crc;
+    return WATCHDOG_STALL_TLV_SIZE;
+}
+
+void watchdog_mgr_stall_clear(void)
+{
+    unsigned int key = irq_lock();
+
+    if (stall_is_valid() && stall.crc == stall_reported_crc) {
+        memset(&stall, 0, sizeof(stall));
+    }
+    irq_unlock(key);
 }
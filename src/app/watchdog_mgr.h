@@ -1,11 +1,16 @@
 #ifndef WATCHDOG_MGR_H
 #define WATCHDOG_MGR_H
 
+#include <zephyr/kernel.h>
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @brief Initialize the Independent Watchdog (WDT)
- * 
+ *
+ * Must be called from the main thread, which is the thread the stall
+ * records describe. Picks up a stall record left by the previous boot.
+ *
  * @param timeout_ms Safety timeout (e.g., 180000 for 3 minutes)
  * @return int 0 on success
  */
@@ -16,4 +21,77 @@ int watchdog_mgr_init(uint32_t timeout_ms);
  */
 void watchdog_mgr_kick(void);
 
+/**
+ * @brief Release the console before an idle wait; logs are drained first.
+ *
+ * With CONFIG_SEAL_CONSOLE_PM the console UART is runtime-PM managed and
+ * suspends once released; otherwise this does nothing.
+ * Pair with watchdog_mgr_idle_exit().
+ */
+void watchdog_mgr_idle_enter(void);
+
+/**
+ * @brief Resume the console after an idle wait.
+ */
+void watchdog_mgr_idle_exit(void);
+
+/**
+ * @brief Kick the watchdog, then sleep with the console suspended.
+ */
+void watchdog_mgr_sleep(k_timeout_t timeout);
+
+/* Longest single sleep in watchdog_mgr_sleep_s(); config_validate() budgets for it */
+#define WATCHDOG_SLEEP_CHUNK_S 10
+
+/**
+ * @brief Sleep @p seconds in WATCHDOG_SLEEP_CHUNK_S pieces, kicking before each.
+ *
+ * For waits that may be longer than the watchdog timeout (retry back-off, deferral).
+ */
+void watchdog_mgr_sleep_s(uint32_t seconds);
+
+/* Code paths with their own deadline, shorter than the global watchdog */
+enum wdt_stage {
+    WDT_STAGE_IDLE = 0,
+    WDT_STAGE_SENSOR,     // VEML6035 configure/read
+    WDT_STAGE_STORAGE,    // NVS flag commit
+    WDT_STAGE_ATTACH,     // Modem init and LTE attach
+    WDT_STAGE_RADIO_EVAL, // Connection evaluation
+    WDT_STAGE_SEND,       // One uplink attempt
+    WDT_STAGE_DNS,        // Server host name lookup
+};
+
+/**
+ * @brief Enter a stage; if it is still running after @p deadline_ms, a
+ *        stall record is captured and a warning logged. Replaces any
+ *        stage already running.
+ */
+void watchdog_mgr_stage_begin(enum wdt_stage stage, uint32_t deadline_ms);
+
+/**
+ * @brief Leave the current stage.
+ */
+void watchdog_mgr_stage_end(void);
+
+/* Encoded size of the stall TLV value */
+#define WATCHDOG_STALL_TLV_SIZE 28
+
+/**
+ * @brief Encode the pending stall record, if any.
+ *
+ * Layout (little endian): reason u8, fsm_state u8, stage u8, overruns u8,
+ * uptime_ms u32, stage_elapsed_ms u32, since_kick_ms u32, pc u32, lr u32,
+ * main stack unused u16, workqueue stack unused u16.
+ *
+ * @return Number of bytes written, 0 if nothing is pending or @p cap is too small.
+ */
+size_t watchdog_mgr_stall_encode(uint8_t *out, size_t cap);
+
+/**
+ * @brief Drop the stall record once the server has acknowledged it.
+ *
+ * A record captured after the last watchdog_mgr_stall_encode() is kept.
+ */
+void watchdog_mgr_stall_clear(void);
+
 #endif
@@ -0,0 +1,147 @@
+import argparse
+import random
+import socket
+import struct
+import sys
+import time
+
+from latency_hist import LatencyHistogram
+
+# Must match src/app/dns.c
+TYPE_A = 1
+CLASS_IN = 1
+FLAG_QR = 0x8000
+FLAG_RD = 0x0100
+FLAG_RA = 0x0080
+RCODE_NXDOMAIN = 3
+
+
+def encode_name(name):
+    out = b''
+    for label in name.rstrip('.').split('.'):
+        out += bytes([len(label)]) + label.encode('ascii')
+    return out + b'\x00'
+
+
+def decode_name(msg, off):
+    labels = []
+    while True:
+        length = msg[off]
+        if length == 0:
+            return '.'.join(labels), off + 1
+        if length & 0xC0:
+            raise ValueError("compressed name in question")
+        labels.append(msg[off + 1:off + 1 + length].decode('ascii', errors='replace'))
+        off += 1 + length
+
+
+def build_answer(query, records, ttl):
+    qid, flags, qdcount = struct.unpack('>HHH', query[:6])
+    if qdcount != 1:
+        raise ValueError(f"{qdcount} questions")
+    name, off = decode_name(query, 12)
+    qtype, qclass = struct.unpack('>HH', query[off:off + 4])
+    question = query[12:off + 4]
+
+    addrs = records.get(name.lower(), []) if (qtype, qclass) == (TYPE_A, CLASS_IN) else []
+    rcode = 0 if name.lower() in records else RCODE_NXDOMAIN
+    header = struct.pack('>HHHHHH', qid, FLAG_QR | (flags & FLAG_RD) | FLAG_RA | rcode,
+                         1, len(addrs), 0, 0)
+    answers = b''
+    for addr in addrs:
+        # Name as a pointer to the question at offset 12, like real resolvers
+        answers += struct.pack('>HHHIH', 0xC00C, TYPE_A, CLASS_IN, ttl, 4) + socket.inet_aton(addr)
+    return name, header + question + answers
+
+
+def parse_records(specs):
+    records = {}
+    for spec in specs:
+        name, _, addrs = spec.partition('=')
+        records[name.lower().rstrip('.')] = [a for a in addrs.split(',') if a]
+    return records
+
+
+def serve(args):
+    records = parse_records(args.record)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.host, args.port))
+    print(f"DNS stand-in on {args.host}:{args.port}, ttl {args.ttl} s: "
+          f"{', '.join(f'{n} -> {a}' for n, a in records.items())}")
+
+    counts = {}
+    try:
+        while True:
+            query, address = sock.recvfrom(512)
+            try:
+                name, reply = build_answer(query, records, args.ttl)
+            except (ValueError, struct.error, IndexError) as e:
+                print(f"  {address[0]}: bad query ({e})")
+                continue
+            counts[name] = counts.get(name, 0) + 1
+            if random.random() < args.drop_rate:
+                print(f"  {address[0]}: {name} -> dropped")
+                continue
+            time.sleep(args.delay_ms / 1000.0)
+            sock.sendto(reply, address)
+            print(f"  {address[0]}: {name} -> {', '.join(records.get(name, [])) or 'NXDOMAIN'} "
+                  f"(query {counts[name]})")
+    except KeyboardInterrupt:
+        print(f"\nQueries per name: {counts}")
+    finally:
+        sock.close()
+    return 0
+
+
+def query(args):
+    """
+    Times lookups with the same single-datagram exchange as the device.
+    """
+    hist = LatencyHistogram()
+    lost = 0
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(args.timeout)
+    for _ in range(args.count):
+        qid = random.getrandbits(16)
+        msg = struct.pack('>HHHHHH', qid, FLAG_RD, 1, 0, 0, 0) + encode_name(args.name) + \
+            struct.pack('>HH', TYPE_A, CLASS_IN)
+        start = time.monotonic()
+        sock.sendto(msg, (args.server, args.port))
+        try:
+            while True:
+                reply = sock.recv(512)
+                if struct.unpack('>H', reply[:2])[0] == qid:
+                    break
+        except socket.timeout:
+            lost += 1
+            continue
+        hist.record((time.monotonic() - start) * 1e6)
+    print(f"{args.name} via {args.server}:{args.port} (us): {hist.summary()}, lost {lost}")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='DNS stand-in for testing the seal endpoint cache')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    sv = sub.add_parser('serve', help='Answer A queries for a fixed set of names')
+    sv.add_argument('--host', default='0.0.0.0')
+    sv.add_argument('--port', type=int, default=53, help='The device always queries port 53')
+    sv.add_argument('--record', action='append', default=[], help='name=a.b.c.d[,a.b.c.d] (repeatable)')
+    sv.add_argument('--ttl', type=int, default=3600)
+    sv.add_argument('--delay-ms', type=float, default=0, help='Added resolver latency')
+    sv.add_argument('--drop-rate', type=float, default=0, help='Fraction of queries left unanswered')
+
+    qu = sub.add_parser('query', help='Time lookups against a resolver')
+    qu.add_argument('name')
+    qu.add_argument('--server', default='127.0.0.1')
+    qu.add_argument('--port', type=int, default=53)
+    qu.add_argument('--count', type=int, default=100)
+    qu.add_argument('--timeout', type=float, default=2.0)
+
+    args = parser.parse_args()
+    return serve(args) if args.cmd == 'serve' else query(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
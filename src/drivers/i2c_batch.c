@@ -0,0 +1,140 @@
+#include "i2c_batch.h"
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(i2c_batch);
+
+void i2c_batch_init(struct i2c_batch *batch, const struct device *bus, uint16_t addr)
+{
+    batch->bus = bus;
+    batch->addr = addr;
+    batch->error = 0;
+    batch->num_msgs = 0;
+    batch->num_ops = 0;
+    batch->result = 0;
+    batch->bus_cycles = 0;
+    batch->cb = NULL;
+    batch->user_data = NULL;
+    k_sem_init(&batch->done, 0, 1);
+}
+
+static uint8_t *i2c_batch_stage(struct i2c_batch *batch, const uint8_t *data, size_t len,
+                                size_t num_msgs)
+{
+    if ((batch->num_ops >= I2C_BATCH_MAX_OPS) || (len > I2C_BATCH_MAX_WRITE) ||
+        ((batch->num_msgs + num_msgs) > ARRAY_SIZE(batch->msgs))) {
+        batch->error = -ENOMEM;
+        return NULL;
+    }
+
+    uint8_t *tx = batch->tx[batch->num_ops++];
+    memcpy(tx, data, len);
+    return tx;
+}
+
+int i2c_batch_write(struct i2c_batch *batch, const uint8_t *data, size_t len)
+{
+    uint8_t *tx = i2c_batch_stage(batch, data, len, 1);
+    if (tx == NULL) {
+        return -ENOMEM;
+    }
+
+    struct i2c_msg *msg = &batch->msgs[batch->num_msgs++];
+    msg->buf = tx;
+    msg->len = len;
+    msg->flags = I2C_MSG_WRITE | I2C_MSG_STOP;
+    return 0;
+}
+
+int i2c_batch_read(struct i2c_batch *batch, const uint8_t *wr, size_t wr_len,
+                   uint8_t *rd, size_t rd_len)
+{
+    uint8_t *tx = i2c_batch_stage(batch, wr, wr_len, 2);
+    if (tx == NULL) {
+        return -ENOMEM;
+    }
+
+    struct i2c_msg *msg = &batch->msgs[batch->num_msgs++];
+    msg->buf = tx;
+    msg->len = wr_len;
+    msg->flags = I2C_MSG_WRITE;
+
+    msg = &batch->msgs[batch->num_msgs++];
+    msg->buf = rd;
+    msg->len = rd_len;
+    msg->flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+    return 0;
+}
+
+static void i2c_batch_complete(const struct device *dev, int result, void *data)
+{
+    ARG_UNUSED(dev);
+    struct i2c_batch *batch = data;
+
+    batch->bus_cycles = k_cycle_get_32() - batch->start_cycles;
+    batch->result = result;
+    if (batch->cb) {
+        batch->cb(result, batch->user_data);
+    }
+}
+
+int i2c_batch_submit(struct i2c_batch *batch, i2c_batch_cb_t cb, void *user_data)
+{
+    if (batch->error) {
+        return batch->error;
+    }
+    if (batch->num_msgs == 0) {
+        return -EINVAL;
+    }
+
+    batch->cb = cb;
+    batch->user_data = user_data;
+    batch->start_cycles = k_cycle_get_32();
+
+#if defined(CONFIG_I2C_CALLBACK)
+    int ret = i2c_transfer_cb(batch->bus, batch->msgs, batch->num_msgs, batch->addr,
+                              i2c_batch_complete, batch);
+    if (ret != -ENOSYS) {
+        return ret;
+    }
+#endif
+
+    // Driver without callback support: one blocking transfer, the CPU still sleeps on EasyDMA
+    i2c_batch_complete(batch->bus,
+                       i2c_transfer(batch->bus, batch->msgs, batch->num_msgs, batch->addr),
+                       batch);
+    return 0;
+}
+
+static void i2c_batch_wake(int result, void *user_data)
+{
+    ARG_UNUSED(result);
+    struct i2c_batch *batch = user_data;
+
+    k_sem_give(&batch->done);
+}
+
+int i2c_batch_run(struct i2c_batch *batch)
+{
+    // The bus is runtime-PM managed: resumed for this sequence, suspended right after
+    int ret = pm_device_runtime_get(batch->bus);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = i2c_batch_submit(batch, i2c_batch_wake, batch);
+    if (ret < 0) {
+        pm_device_runtime_put(batch->bus);
+        return ret;
+    }
+
+    k_sem_take(&batch->done, K_FOREVER);
+    pm_device_runtime_put(batch->bus);
+
+    if (batch->result < 0) {
+        LOG_ERR("Batch to 0x%02X failed: %d", batch->addr, batch->result);
+    }
+    return batch->result;
+}
@@ -0,0 +1,76 @@
+#ifndef I2C_BATCH_H
+#define I2C_BATCH_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+#include <stdint.h>
+
+/**
+ * @file i2c_batch.h
+ * @brief Queue a sequence of register operations and run it as one I2C transfer.
+ *
+ * The whole sequence is handed to the TWIM driver in a single call and
+ * completes with one callback, so the CPU can sleep while EasyDMA drives
+ * the bus instead of waking up between registers.
+ */
+
+#define I2C_BATCH_MAX_OPS   8 // Register operations per batch
+#define I2C_BATCH_MAX_WRITE 4 // Bytes per write (register address + data)
+
+typedef void (*i2c_batch_cb_t)(int result, void *user_data);
+
+struct i2c_batch {
+    const struct device *bus;
+    uint16_t addr;
+    int error;          // Sticky queueing error, reported on submit
+    uint8_t num_msgs;
+    uint8_t num_ops;
+    struct i2c_msg msgs[2 * I2C_BATCH_MAX_OPS];
+    uint8_t tx[I2C_BATCH_MAX_OPS][I2C_BATCH_MAX_WRITE];
+    struct k_sem done;
+    int result;
+    uint32_t start_cycles;
+    uint32_t bus_cycles; // Submit to completion of the last run
+    i2c_batch_cb_t cb;
+    void *user_data;
+};
+
+/**
+ * @brief Start an empty batch for one target on one bus.
+ */
+void i2c_batch_init(struct i2c_batch *batch, const struct device *bus, uint16_t addr);
+
+/**
+ * @brief Queue a register write. @p data is copied.
+ * @return 0 on success, -ENOMEM if the batch is full.
+ */
+int i2c_batch_write(struct i2c_batch *batch, const uint8_t *data, size_t len);
+
+/**
+ * @brief Queue a register read (write address, repeated start, read).
+ * @p wr is copied; @p rd must stay valid until the batch completes.
+ * @return 0 on success, -ENOMEM if the batch is full.
+ */
+int i2c_batch_read(struct i2c_batch *batch, const uint8_t *wr, size_t wr_len,
+                   uint8_t *rd, size_t rd_len);
+
+/**
+ * @brief Run the queued sequence asynchronously.
+ *
+ * @p cb is called once, possibly from interrupt context, when the whole
+ * sequence has completed or the first operation has failed.
+ *
+ * The bus must already be resumed: hold a pm_device_runtime_get()
+ * reference until @p cb has run (i2c_batch_run() does this).
+ *
+ * @return 0 if submitted, negative errno otherwise (cb is not called).
+ */
+int i2c_batch_submit(struct i2c_batch *batch, i2c_batch_cb_t cb, void *user_data);
+
+/**
+ * @brief Run the queued sequence and sleep until it completes.
+ * @return Result of the transfer.
+ */
+int i2c_batch_run(struct i2c_batch *batch);
+
+#endif // I2C_BATCH_H
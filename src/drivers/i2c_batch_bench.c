@@ -0,0 +1,95 @@
+#include "i2c_batch_bench.h"
+#include "i2c_batch.h"
+#include "veml6035.h"
+#include "npm1300.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+
+LOG_MODULE_REGISTER(i2c_bench);
+
+#define BENCH_ITERATIONS 20
+
+struct bench_result {
+    uint32_t wall_us;
+    uint32_t awake_us;
+};
+
+typedef int (*bench_fn_t)(const struct device *bus);
+
+/* Legacy sequences: one blocking transaction per register, as before batching */
+static int legacy_veml_write(const struct device *bus, uint8_t reg, uint16_t value)
+{
+    uint8_t buf[3] = { reg, (uint8_t)(value & 0xFF), (uint8_t)(value >> 8) };
+    return i2c_write(bus, buf, sizeof(buf), VEML6035_I2C_ADDR);
+}
+
+static int legacy_veml_configure(const struct device *bus)
+{
+    int ret = legacy_veml_write(bus, VEML6035_REG_ALS_CONF, 0x0001);
+    ret |= legacy_veml_write(bus, VEML6035_REG_ALS_WH, 0x00A0);
+    ret |= legacy_veml_write(bus, VEML6035_REG_ALS_WL, 0x0000);
+    ret |= legacy_veml_write(bus, VEML6035_REG_ALS_CONF, 0x0002);
+    return ret;
+}
+
+static int legacy_npm_write(const struct device *bus, uint16_t reg, uint8_t value)
+{
+    uint8_t buf[3] = { (uint8_t)(reg >> 8), (uint8_t)(reg & 0xFF), value };
+    return i2c_write(bus, buf, sizeof(buf), NPM1300_I2C_ADDR);
+}
+
+static int legacy_npm_bring_up(const struct device *bus)
+{
+    uint8_t reg[2] = { NPM1300_REG_BUCK1_STATUS >> 8, NPM1300_REG_BUCK1_STATUS & 0xFF };
+    uint8_t status;
+    int ret = i2c_write_read(bus, NPM1300_I2C_ADDR, reg, sizeof(reg), &status, 1);
+    ret |= legacy_npm_write(bus, NPM1300_REG_BUCK1_NORM_VOUT, NPM1300_VOUT_3V0);
+    ret |= legacy_npm_write(bus, NPM1300_REG_BUCK1_CTRL, NPM1300_BUCK_CTRL_ENABLE);
+    ret |= legacy_npm_write(bus, NPM1300_REG_BUCK2_NORM_VOUT, NPM1300_VOUT_1V8);
+    ret |= legacy_npm_write(bus, NPM1300_REG_BUCK2_CTRL, NPM1300_BUCK_CTRL_ENABLE);
+    return ret;
+}
+
+static int bench_run(bench_fn_t fn, const struct device *bus, struct bench_result *res)
+{
+    k_thread_runtime_stats_t before, after;
+    int ret = 0;
+
+    // Keep the bus resumed so both variants time transfers, not PM transitions
+    pm_device_runtime_get(bus);
+    k_thread_runtime_stats_all_get(&before);
+    uint32_t start = k_cycle_get_32();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        ret |= fn(bus);
+    }
+
+    uint32_t wall = k_cycle_get_32() - start;
+    k_thread_runtime_stats_all_get(&after);
+    pm_device_runtime_put(bus);
+
+    // total_cycles counts non-idle time, i.e. time the CPU was awake
+    res->wall_us = k_cyc_to_us_floor32(wall) / BENCH_ITERATIONS;
+    res->awake_us = (uint32_t)k_cyc_to_us_floor64(after.total_cycles - before.total_cycles) /
+                    BENCH_ITERATIONS;
+    return ret;
+}
+
+static void bench_compare(const char *name, bench_fn_t legacy, bench_fn_t batched,
+                          const struct device *bus)
+{
+    struct bench_result a, b;
+    int ra = bench_run(legacy, bus, &a);
+    int rb = bench_run(batched, bus, &b);
+
+    LOG_INF("%s legacy : %u us bus, %u us awake (%d)", name, a.wall_us, a.awake_us, ra);
+    LOG_INF("%s batched: %u us bus, %u us awake (%d)", name, b.wall_us, b.awake_us, rb);
+}
+
+void i2c_batch_bench_run(const struct device *sensor_bus, const struct device *pmic_bus)
+{
+    LOG_INF("I2C batch benchmark, %d iterations per sequence", BENCH_ITERATIONS);
+    bench_compare("VEML6035 configure", legacy_veml_configure, veml6035_configure, sensor_bus);
+    bench_compare("NPM1300 bring-up", legacy_npm_bring_up, npm1300_bring_up, pmic_bus);
+}
@@ -0,0 +1,14 @@
+#ifndef I2C_BATCH_BENCH_H
+#define I2C_BATCH_BENCH_H
+
+#include <zephyr/device.h>
+
+/**
+ * @brief Compare per-register and batched configuration sequences.
+ *
+ * Logs the average bus time and CPU-awake time per sequence for the
+ * VEML6035 configure and NPM1300 bring-up paths.
+ */
+void i2c_batch_bench_run(const struct device *sensor_bus, const struct device *pmic_bus);
+
+#endif // I2C_BATCH_BENCH_H
@@ -1,92 +1,99 @@
 #include "npm1300.h"
+#include "i2c_batch.h"
 #include <zephyr/logging/log.h>
 #include <errno.h>
 
 LOG_MODULE_REGISTER(npm1300, CONFIG_LOG_DEFAULT_LEVEL);
 
-// Helper for register writing
-static int npm1300_write_reg(const struct device *i2c_dev, uint16_t reg, uint8_t value)
+/* Register sequences are queued here and run as a single bus transfer */
+static struct i2c_batch batch;
+
+static void npm1300_queue_write(uint16_t reg, uint8_t value)
 {
     // Format: [RegAddr High] [RegAddr Low] [Data]
     uint8_t buf[3];
     buf[0] = (uint8_t)((reg >> 8) & 0xFF);
     buf[1] = (uint8_t)(reg & 0xFF);
     buf[2] = value;
-    
-    return i2c_write(i2c_dev, buf, 3, NPM1300_I2C_ADDR);
+    i2c_batch_write(&batch, buf, 3);
 }
 
-// Helper for register reading
-static int npm1300_read_reg(const struct device *i2c_dev, uint16_t reg, uint8_t *value)
+static void npm1300_queue_read(uint16_t reg, uint8_t *value)
 {
     uint8_t reg_addr[2];
     reg_addr[0] = (uint8_t)((reg >> 8) & 0xFF);
     reg_addr[1] = (uint8_t)(reg & 0xFF);
-    
-    return i2c_write_read(i2c_dev, NPM1300_I2C_ADDR, reg_addr, 2, value, 1);
+    i2c_batch_read(&batch, reg_addr, 2, value, 1);
+}
+
+// BUCK1 (System/Modem) -> 3.0V, BUCK2 (GPIO/Aux) -> 1.8V, both enabled
+static void npm1300_queue_bucks(void)
+{
+    npm1300_queue_write(NPM1300_REG_BUCK1_NORM_VOUT, NPM1300_VOUT_3V0);
+    npm1300_queue_write(NPM1300_REG_BUCK1_CTRL, NPM1300_BUCK_CTRL_ENABLE);
+    npm1300_queue_write(NPM1300_REG_BUCK2_NORM_VOUT, NPM1300_VOUT_1V8);
+    npm1300_queue_write(NPM1300_REG_BUCK2_CTRL, NPM1300_BUCK_CTRL_ENABLE);
 }
 
-int npm1300_init(const struct device *i2c_dev)
+int npm1300_bring_up(const struct device *i2c_dev)
 {
     if (!device_is_ready(i2c_dev)) {
         LOG_ERR("I2C device not ready");
         return -ENODEV;
     }
 
-    uint8_t dummy;
-    int ret = npm1300_read_reg(i2c_dev, NPM1300_REG_BUCK1_STATUS, &dummy);
+    // Probe and buck setup in one transfer; a missing PMIC NACKs the first read and aborts the rest
+    uint8_t status;
+    i2c_batch_init(&batch, i2c_dev, NPM1300_I2C_ADDR);
+    npm1300_queue_read(NPM1300_REG_BUCK1_STATUS, &status);
+    npm1300_queue_bucks();
+
+    int ret = i2c_batch_run(&batch);
     if (ret < 0) {
         LOG_ERR("NPM1300 not found at 0x%02X", NPM1300_I2C_ADDR);
         return -ENODEV;
     }
 
-    LOG_INF("NPM1300 found! ID/Status Val: 0x%02X", dummy);
+    LOG_INF("NPM1300 found (Status 0x%02X), Bucks Enabled. Bus %u us", status,
+            k_cyc_to_us_floor32(batch.bus_cycles));
     return 0;
 }
 
-int npm1300_enable_bucks(const struct device *i2c_dev)
+int npm1300_verify_bucks(const struct device *i2c_dev)
 {
-    int ret = 0;
-
-    // 1. Configure BUCK1 (System/Modem) -> 3.0V
-    LOG_INF("Setting BUCK1 to 3.0V...");
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK1_NORM_VOUT, NPM1300_VOUT_3V0);
-    if (ret < 0) return ret;
-
-    // Enable BUCK1
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK1_CTRL, NPM1300_BUCK_CTRL_ENABLE);
-    if (ret < 0) return ret;
+    uint8_t vout1, ctrl1, vout2, ctrl2;
 
+    i2c_batch_init(&batch, i2c_dev, NPM1300_I2C_ADDR);
+    npm1300_queue_read(NPM1300_REG_BUCK1_NORM_VOUT, &vout1);
+    npm1300_queue_read(NPM1300_REG_BUCK1_CTRL, &ctrl1);
+    npm1300_queue_read(NPM1300_REG_BUCK2_NORM_VOUT, &vout2);
+    npm1300_queue_read(NPM1300_REG_BUCK2_CTRL, &ctrl2);
 
-    // 2. Configure BUCK2 (GPIO/Aux) -> 1.8V
-    LOG_INF("Setting BUCK2 to 1.8V...");
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK2_NORM_VOUT, NPM1300_VOUT_1V8);
-    if (ret < 0) return ret;
-
-    // Enable BUCK2
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK2_CTRL, NPM1300_BUCK_CTRL_ENABLE);
-    if (ret < 0) return ret;
+    int ret = i2c_batch_run(&batch);
+    if (ret < 0) {
+        return ret;
+    }
 
-    LOG_INF("NPM1300 Bucks Enabled.");
+    if (vout1 != NPM1300_VOUT_3V0 || vout2 != NPM1300_VOUT_1V8 ||
+        !(ctrl1 & NPM1300_BUCK_CTRL_ENABLE) || !(ctrl2 & NPM1300_BUCK_CTRL_ENABLE)) {
+        LOG_ERR("Buck readback mismatch: 0x%02X/0x%02X 0x%02X/0x%02X", vout1, ctrl1, vout2, ctrl2);
+        return -EIO;
+    }
     return 0;
 }
 
 int npm1300_hibernate(const struct device *i2c_dev)
 {
-    int ret = 0;
-    
     LOG_INF("Hibernating NPM1300 (Disabling BUCKs)...");
 
-    // Disable BUCK2
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK2_CTRL, 0x00); // Disable
-    if (ret < 0) {
-        LOG_ERR("Failed to disable BUCK2");
-    }
+    // Disable BUCK2, then BUCK1 (System Power usually)
+    i2c_batch_init(&batch, i2c_dev, NPM1300_I2C_ADDR);
+    npm1300_queue_write(NPM1300_REG_BUCK2_CTRL, 0x00);
+    npm1300_queue_write(NPM1300_REG_BUCK1_CTRL, 0x00);
 
-    // Disable BUCK1 (System Power usually)
-    ret = npm1300_write_reg(i2c_dev, NPM1300_REG_BUCK1_CTRL, 0x00); // Disable
+    int ret = i2c_batch_run(&batch);
     if (ret < 0) {
-        LOG_ERR("Failed to disable BUCK1");
+        LOG_ERR("Failed to disable BUCKs");
     }
 
     return ret;
@@ -27,14 +27,15 @@
 #define NPM1300_VOUT_1V8 0x0C
 
 /**
- * @brief Initialize the NPM1300 and verify presence.
+ * @brief Probe the NPM1300 and enable both bucks in a single bus transfer.
  */
-int npm1300_init(const struct device *i2c_dev);
+int npm1300_bring_up(const struct device *i2c_dev);
 
 /**
- * @brief Enable Buck1 (System/Modem) and Buck2 (GPIO)
+ * @brief Read back both buck voltage and enable registers in one transfer.
+ * @return 0 if they match npm1300_bring_up(), -EIO if not, negative errno on bus error.
  */
-int npm1300_enable_bucks(const struct device *i2c_dev);
+int npm1300_verify_bucks(const struct device *i2c_dev);
 
 /**
  * @brief Hibernate the NPM1300 (Disable Bucks)
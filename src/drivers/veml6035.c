@@ -1,4 +1,5 @@
 #include "veml6035.h"
+#include "i2c_batch.h"
 #include <zephyr/logging/log.h>
 #include <errno.h>
 
@@ -9,21 +10,35 @@ LOG_MODULE_REGISTER(veml6035);
 #define VEML6035_CONF_SENS_POS    12
 #define VEML6035_CONF_IT_POS      6
 
-// Write
-static int veml6035_write_reg(const struct device *i2c_dev, uint8_t reg, uint16_t value)
+/* Register sequences are queued here and run as a single bus transfer */
+static struct i2c_batch batch;
+
+static uint16_t int_high_threshold = 0x00A0;
+
+static void veml6035_queue_write(uint8_t reg, uint16_t value)
 {
     uint8_t buf[3];
     buf[0] = reg;
     buf[1] = (uint8_t)(value & 0xFF);
     buf[2] = (uint8_t)((value >> 8) & 0xFF);
-    return i2c_write(i2c_dev, buf, 3, VEML6035_I2C_ADDR);
+    i2c_batch_write(&batch, buf, 3);
+}
+
+// Write
+static int veml6035_write_reg(const struct device *i2c_dev, uint8_t reg, uint16_t value)
+{
+    i2c_batch_init(&batch, i2c_dev, VEML6035_I2C_ADDR);
+    veml6035_queue_write(reg, value);
+    return i2c_batch_run(&batch);
 }
 
 // Read 
 static int veml6035_read_reg(const struct device *i2c_dev, uint8_t reg, uint16_t *value)
 {
     uint8_t buf[2];
-    int ret = i2c_write_read(i2c_dev, VEML6035_I2C_ADDR, &reg, 1, buf, 2);
+    i2c_batch_init(&batch, i2c_dev, VEML6035_I2C_ADDR);
+    i2c_batch_read(&batch, &reg, 1, buf, 2);
+    int ret = i2c_batch_run(&batch);
     if (ret == 0) {
         *value = (buf[1] << 8) | buf[0];
     }
@@ -53,33 +68,34 @@ int veml6035_init(const struct device *i2c_dev)
 
 int veml6035_configure(const struct device *i2c_dev)
 {
-    int ret = 0;
-    
     // 1. Shutdown first to configure safely
-    ret = veml6035_shutdown(i2c_dev);
-    if (ret < 0) return ret;
-
     // 2. Set Thresholds for Interrupt
-    uint16_t high_threshold = 0x00A0; 
+    // 3. Configure and Enable Interrupt
+    // All four writes go out in one batched transfer.
+    uint16_t high_threshold = int_high_threshold; 
     uint16_t low_threshold = 0x0000;
 
-    ret = veml6035_write_reg(i2c_dev, VEML6035_REG_ALS_WH, high_threshold);
-    if (ret < 0) return ret;
-    ret = veml6035_write_reg(i2c_dev, VEML6035_REG_ALS_WL, low_threshold);
-    if (ret < 0) return ret;
-
-    // 3. Configure and Enable Interrupt
     uint16_t conf = 0;
     conf |= (0 << VEML6035_CONF_SD_POS);       // Power ON
     conf |= (1 << VEML6035_CONF_INT_EN_POS);   // Interrupt Enable
     conf |= (0 << VEML6035_CONF_SENS_POS);     // Sensitivity x1 (Normal)
-    
-    // Write Configuration
-    ret = veml6035_write_reg(i2c_dev, VEML6035_REG_ALS_CONF, conf);
-    
+
+    i2c_batch_init(&batch, i2c_dev, VEML6035_I2C_ADDR);
+    veml6035_queue_write(VEML6035_REG_ALS_CONF, (1 << VEML6035_CONF_SD_POS));
+    veml6035_queue_write(VEML6035_REG_ALS_WH, high_threshold);
+    veml6035_queue_write(VEML6035_REG_ALS_WL, low_threshold);
+    veml6035_queue_write(VEML6035_REG_ALS_CONF, conf);
+
+    int ret = i2c_batch_run(&batch);
+    LOG_DBG("Configure: %d, bus %u us", ret, k_cyc_to_us_floor32(batch.bus_cycles));
     return ret;
 }
 
+void veml6035_set_int_threshold(uint16_t high_threshold)
+{
+    int_high_threshold = high_threshold;
+}
+
 int veml6035_enable_interrupt(const struct device *i2c_dev, bool enable)
 {
     uint16_t conf = 0;
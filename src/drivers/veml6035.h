@@ -19,6 +19,8 @@
 // Function Prototypes
 int veml6035_init(const struct device *i2c_dev);
 int veml6035_configure(const struct device *i2c_dev);
+// High threshold used by the next veml6035_configure() (default 0x00A0)
+void veml6035_set_int_threshold(uint16_t high_threshold);
 int veml6035_read_als(const struct device *i2c_dev, uint16_t *lux_counts);
 int veml6035_enable_interrupt(const struct device *i2c_dev, bool enable);
 int veml6035_shutdown(const struct device *i2c_dev);
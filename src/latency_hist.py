@@ -0,0 +1,86 @@
+import math
+from collections import OrderedDict
+
+
+class LatencyHistogram:
+    """
+    HDR-style log-linear histogram with a fixed number of counters.
+
+    Values (ms) are bucketed by power of two, each split into SUB_BUCKETS
+    linear sub-buckets, so the relative error is bounded by 1/SUB_BUCKETS
+    and memory does not grow with the number of samples.
+    """
+
+    SUB_BUCKETS = 16
+    MAX_EXPONENT = 24  # 2^24 ms ~ 4.6 h; larger values land in the last bucket
+
+    def __init__(self):
+        self.counts = [0] * (self.SUB_BUCKETS * (self.MAX_EXPONENT + 1))
+        self.total = 0
+        self.min = None
+        self.max = None
+
+    def _index(self, value):
+        if value < self.SUB_BUCKETS:
+            return int(value)
+        exp = (int(value).bit_length() - 1) - (self.SUB_BUCKETS.bit_length() - 1) + 1
+        if exp > self.MAX_EXPONENT:
+            return len(self.counts) - 1
+        sub = int(value) >> (exp - 1)
+        return exp * self.SUB_BUCKETS + (sub - self.SUB_BUCKETS)
+
+    def _value_at(self, index):
+        exp, sub = divmod(index, self.SUB_BUCKETS)
+        if exp == 0:
+            return sub
+        # Upper edge of the bucket, so percentiles never under-report
+        return ((self.SUB_BUCKETS + sub + 1) << (exp - 1)) - 1
+
+    def record(self, value):
+        value = max(0, int(value))
+        self.counts[self._index(value)] += 1
+        self.total += 1
+        self.min = value if self.min is None else min(self.min, value)
+        self.max = value if self.max is None else max(self.max, value)
+
+    def percentile(self, p):
+        if self.total == 0:
+            return None
+        target = max(1, math.ceil(self.total * p / 100.0))
+        seen = 0
+        for i, c in enumerate(self.counts):
+            seen += c
+            if seen >= target:
+                return min(self._value_at(i), self.max)
+        return self.max
+
+    def summary(self, percentiles=(50, 90, 99, 99.9)):
+        parts = [f"n={self.total}"]
+        if self.total:
+            parts.append(f"min={self.min}")
+            parts += [f"p{p:g}={self.percentile(p)}" for p in percentiles]
+            parts.append(f"max={self.max}")
+        return " ".join(parts)
+
+
+class KeyedHistograms:
+    """
+    One histogram per key (device, firmware, cell, ...), bounded by evicting
+    the least recently updated key once max_keys is reached.
+    """
+
+    def __init__(self, max_keys=1024):
+        self.max_keys = max_keys
+        self.hists = OrderedDict()
+
+    def record(self, key, value):
+        hist = self.hists.pop(key, None)
+        if hist is None:
+            hist = LatencyHistogram()
+            if len(self.hists) >= self.max_keys:
+                self.hists.popitem(last=False)
+        self.hists[key] = hist
+        hist.record(value)
+
+    def items(self):
+        return self.hists.items()
@@ -0,0 +1,104 @@
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def zero_run_decompress(data):
+    """
+    Reverses the device-side zero-run compression: 0x00 <count> -> count zeros.
+    """
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        b = data[i]
+        if b == 0x00:
+            if i + 1 >= len(data):
+                raise ValueError("Truncated zero run at end of input")
+            out.extend(b'\x00' * data[i + 1])
+            i += 2
+        else:
+            out.append(b)
+            i += 1
+    return bytes(out)
+
+
+def read_dump(path):
+    """
+    Extracts the ring bytes from a console capture containing #LR: lines.
+    """
+    raw = bytearray()
+    inside = False
+    with open(path, 'r', errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            if line == '#LR:BEGIN':
+                raw.clear()
+                inside = True
+            elif line == '#LR:END':
+                inside = False
+            elif inside and line.startswith('#LR:'):
+                raw.extend(bytes.fromhex(line[4:]))
+    return bytes(raw)
+
+
+def unframe(ring_bytes):
+    """
+    Strips the [len] prefix of each ring record, returning the dictionary stream.
+    """
+    stream = bytearray()
+    i = 0
+    count = 0
+    while i < len(ring_bytes):
+        length = ring_bytes[i]
+        record = ring_bytes[i + 1:i + 1 + length]
+        if len(record) != length:
+            print(f"Warning: truncated record at offset {i}", file=sys.stderr)
+            break
+        stream.extend(record)
+        i += 1 + length
+        count += 1
+    return bytes(stream), count
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode Security Seal binary log ring records')
+    src = parser.add_mutually_exclusive_group(required=True)
+    src.add_argument('--dump', help='Console capture containing a #LR: ring dump')
+    src.add_argument('--uplink', help='Compressed log tail saved by udp_server.py (.lrz)')
+    parser.add_argument('--db', required=True, help='log_dictionary.json from the firmware build')
+    parser.add_argument('--zephyr-base', default=os.environ.get('ZEPHYR_BASE'),
+                        help='Zephyr tree providing scripts/logging/dictionary/log_parser.py')
+    parser.add_argument('--raw-out', help='Also write the unframed dictionary stream here')
+    args = parser.parse_args()
+
+    if args.dump:
+        ring_bytes = read_dump(args.dump)
+    else:
+        with open(args.uplink, 'rb') as f:
+            ring_bytes = zero_run_decompress(f.read())
+
+    stream, count = unframe(ring_bytes)
+    print(f"{count} records, {len(stream)} bytes", file=sys.stderr)
+
+    if args.raw_out:
+        with open(args.raw_out, 'wb') as f:
+            f.write(stream)
+
+    if not args.zephyr_base:
+        print("Error: set ZEPHYR_BASE or pass --zephyr-base", file=sys.stderr)
+        return 1
+
+    log_parser = os.path.join(args.zephyr_base, 'scripts', 'logging', 'dictionary', 'log_parser.py')
+    with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as tmp:
+        tmp.write(stream)
+        tmp_path = tmp.name
+    try:
+        return subprocess.call([sys.executable, log_parser, args.db, tmp_path])
+    finally:
+        os.unlink(tmp_path)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
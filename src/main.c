@@ -6,17 +6,33 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/pm/device_runtime.h>
 #include "app/fsm.h"
 #include "app/watchdog_mgr.h"
+#include "app/log_ring.h"
+#include "app/config.h"
 #include "drivers/npm1300.h"
+#include "drivers/i2c_batch_bench.h"
 
 LOG_MODULE_REGISTER(main);
 
 int main(void)
 {
+#if defined(CONFIG_SEAL_CONSOLE_PM)
+    /* Console is runtime-PM managed: hold it while awake, idle waits release it */
+    const struct device *console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+    pm_device_runtime_enable(console);
+    pm_device_runtime_get(console);
+#endif
+
     LOG_INF("Security Seal Booting...");
 
-    /* --- LED Indication for Reset/Boot --- */
+#if defined(CONFIG_SEAL_LOG_RING)
+    log_ring_dump_on_request();
+#endif
+
+#if defined(CONFIG_SEAL_BOOT_LED)
+    /* --- LED Indication for Reset/Boot (1.2 s of System ON per wake) --- */
     const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios);
     if (gpio_is_ready_dt(&led)) {
         gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
@@ -30,17 +46,22 @@ int main(void)
     } else {
         LOG_ERR("LED device not ready");
     }
+#endif
 
 
     /* --- NPM1300 PMIC Init --- */
     const struct device *pmic_i2c = DEVICE_DT_GET(DT_NODELABEL(i2c1));
-    if (npm1300_init(pmic_i2c) == 0) {
-        npm1300_enable_bucks(pmic_i2c);
-    } else {
+    if (npm1300_bring_up(pmic_i2c) < 0) {
         LOG_ERR("NPM1300 Init Failed! Power rails may be down.");
     }
 
-    int rc = watchdog_mgr_init(180000); // 3 minutes
+#if defined(CONFIG_SEAL_I2C_BENCH)
+    i2c_batch_bench_run(DEVICE_DT_GET(DT_NODELABEL(i2c2)), pmic_i2c);
+#endif
+
+    config_init();
+
+    int rc = watchdog_mgr_init(config_get()->wdt_timeout_ms); // 3 minutes by default
     if (rc < 0) {
         LOG_ERR("Watchdog Init Failed: %d", rc);
     }
@@ -58,6 +79,8 @@ int main(void)
         if (rc < 0) {
              LOG_ERR("FSM Critical Failure: %d", rc);
         }
-        k_sleep(K_SECONDS(1));
+        if (CONFIG_SEAL_FSM_STEP_MS > 0) {
+            k_sleep(K_MSEC(CONFIG_SEAL_FSM_STEP_MS));
+        }
     }
 }
@@ -2,17 +2,33 @@
 #include <zephyr/sys/poweroff.h>
 #include <modem/nrf_modem_lib.h>
 #include <modem/lte_lc.h>
+#include <nrf_modem_at.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/hwinfo.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_DECLARE(main);
 
 #include "../app/watchdog_mgr.h"
+#include "../app/retained.h"
 #include <zephyr/kernel.h>
+#include <string.h>
 
-static bool modem_active = false;
+static bool modem_lib_ready = false; // nrf_modem_lib initialised, attached or not
+static bool modem_active = false;    // Attached to the network
+static uint32_t cell_id = UINT32_MAX;
+static uint32_t cell_tac = UINT32_MAX;
+static int64_t modem_on_time_ms = 0;
 static K_SEM_DEFINE(lte_connected, 0, 1);
 
+/* RRC state from +CSCON, and whether the network granted PSM in the last update */
+static volatile bool rrc_connected = false;
+static volatile bool psm_granted = false;
+static K_SEM_DEFINE(rrc_idle, 0, 1);
+
+/* Longest wait for the network to release the RRC connection after a park request */
+#define PARK_RRC_WAIT_S 60
+
 static void lte_handler(const struct lte_lc_evt *const evt)
 {
      switch (evt->type) {
@@ -23,6 +39,20 @@ static void lte_handler(const struct lte_lc_evt *const evt)
              k_sem_give(&lte_connected);
         }
         break;
+     case LTE_LC_EVT_CELL_UPDATE:
+        cell_id = evt->cell.id;
+        cell_tac = evt->cell.tac;
+        break;
+     case LTE_LC_EVT_RRC_UPDATE:
+        rrc_connected = (evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED);
+        if (!rrc_connected) {
+            k_sem_give(&rrc_idle);
+        }
+        break;
+     case LTE_LC_EVT_PSM_UPDATE:
+        // An active time of -1 means the network did not grant PSM
+        psm_granted = (evt->psm_cfg.active_time >= 0);
+        break;
      default:
         break;
      }
@@ -30,17 +60,42 @@ static void lte_handler(const struct lte_lc_evt *const evt)
 
 int power_mgr_modem_init(void)
 {
+    if (modem_active) {
+        // Warm monitoring: still attached, the first datagram brings the modem out of PSM
+        return 0;
+    }
+
+    modem_on_time_ms = k_uptime_get();
+
     int err = nrf_modem_lib_init();
     if (err) {
         LOG_ERR("Modem lib init failed: %d", err);
+        power_mgr_modem_off();
         return err;
     }
+    modem_lib_ready = true;
+
+#if defined(CONFIG_SEAL_MONITOR_WARM_PSM)
+    err = lte_lc_psm_param_set_seconds(CONFIG_SEAL_PSM_TAU_SECONDS,
+                                       CONFIG_SEAL_PSM_ACTIVE_TIME_SECONDS);
+    if (err) {
+        LOG_WRN("PSM param set failed: %d", err);
+    }
+    err = lte_lc_psm_req(true);
+    if (err) {
+        LOG_WRN("PSM request failed: %d", err);
+    }
+#endif
     
     LOG_INF("Connecting to LTE network (Async)...");
+    // A registration left over from an earlier attach this boot must not count
+    k_sem_reset(&lte_connected);
     
     err = lte_lc_connect_async(lte_handler);
     if (err) {
         LOG_ERR("LTE connection request failed: %d", err);
+        // Undo the partial init so the next attempt starts from a shut-down library
+        power_mgr_modem_off();
         return err;
     }
 
@@ -48,11 +103,10 @@ int power_mgr_modem_init(void)
     while (k_sem_take(&lte_connected, K_NO_WAIT) != 0) {
         if (retries-- <= 0) {
             LOG_ERR("LTE Connection Timeout!");
-            lte_lc_power_off();
+            power_mgr_modem_off();
             return -ETIMEDOUT;
         }
-        watchdog_mgr_kick();
-        k_sleep(K_SECONDS(1));
+        watchdog_mgr_sleep(K_SECONDS(1));
     }
 
     LOG_INF("LTE Connected!");
@@ -60,16 +114,126 @@ int power_mgr_modem_init(void)
     return 0;
 }
 
-void power_mgr_system_off(void)
+uint32_t power_mgr_reset_cause(void)
 {
-    // Shutdown Modem
-    if (modem_active) {
+    static bool cached = false;
+    static uint32_t cause = 0;
+
+    if (!cached) {
+        hwinfo_get_reset_cause(&cause);
+        // RESETREAS bits accumulate; clear so the next boot sees only its own cause
+        hwinfo_clear_reset_cause();
+        cached = true;
+    }
+    return cause;
+}
+
+int power_mgr_get_cell(uint32_t *id, uint32_t *tac)
+{
+    if (cell_id == UINT32_MAX) {
+        return -ENODATA;
+    }
+    *id = cell_id;
+    *tac = cell_tac;
+    return 0;
+}
+
+int power_mgr_get_dns_server(char *buf, size_t len)
+{
+    char rsp[128];
+
+    // +CGCONTRDP: <cid>,<bearer>,"<apn>","<addr/mask>","<gw>","<dns1>","<dns2>",...
+    int err = nrf_modem_at_cmd(rsp, sizeof(rsp), "AT+CGCONTRDP=0");
+    if (err) {
+        return (err < 0) ? err : -ENODATA;
+    }
+
+    const char *field = strchr(rsp, ':');
+    for (int i = 0; field != NULL && i < 5; i++) {
+        field = strchr(field + 1, ',');
+    }
+    if (field == NULL) {
+        return -ENODATA;
+    }
+    field += (field[1] == '"') ? 2 : 1;
+
+    size_t n = strcspn(field, "\",\r\n");
+    if (n == 0 || n >= len) {
+        return -ENODATA;
+    }
+    memcpy(buf, field, n);
+    buf[n] = '\0';
+    return 0;
+}
+
+int power_mgr_get_radio_metrics(struct radio_metrics *metrics)
+{
+    struct lte_lc_conn_eval_params params = {0};
+
+    int err = lte_lc_conn_eval_params_get(&params);
+    if (err) {
+        // Positive values are modem result codes, e.g. not registered
+        return (err < 0) ? err : -EAGAIN;
+    }
+
+    metrics->rsrp = params.rsrp;
+    metrics->rsrq = params.rsrq;
+    metrics->tx_power = params.tx_power;
+    metrics->ce_level = params.ce_level;
+    metrics->energy_estimate = params.energy_estimate;
+    return 0;
+}
+
+int power_mgr_modem_park(void)
+{
+    int err = lte_lc_psm_req(true);
+    if (err) {
+        LOG_WRN("PSM request failed: %d", err);
+        return err;
+    }
+
+    // PSM only starts after the network releases the RRC connection (inactivity timer)
+    k_sem_reset(&rrc_idle);
+    for (int waited = 0; rrc_connected && waited < PARK_RRC_WAIT_S; waited++) {
+        watchdog_mgr_kick();
+        k_sem_take(&rrc_idle, K_SECONDS(1));
+    }
+    if (rrc_connected) {
+        LOG_WRN("RRC still connected after %d s", PARK_RRC_WAIT_S);
+        return -ETIMEDOUT;
+    }
+    if (!psm_granted) {
+        LOG_WRN("Network did not grant PSM, idling in RRC idle with eDRX/paging");
+        return -EAGAIN;
+    }
+    return 0;
+}
+
+void power_mgr_modem_off(void)
+{
+    // Also undoes a partial init: library up but never attached
+    if (modem_lib_ready) {
         LOG_INF("Shutting down LTE...");
         lte_lc_power_off();
         nrf_modem_lib_shutdown();
+        modem_lib_ready = false;
         modem_active = false;
     }
 
+    if (modem_on_time_ms > 0) {
+        retained_get()->ledger.modem_on_ms += (uint32_t)(k_uptime_get() - modem_on_time_ms);
+        retained_update();
+        modem_on_time_ms = 0;
+    }
+}
+
+void power_mgr_system_off(void)
+{
+    power_mgr_modem_off();
+
+    // Keep the retained state block alive through System OFF
+    retained_prepare_off();
+
     // Enter System OFF
     LOG_INF("System Power Off");
     sys_poweroff();
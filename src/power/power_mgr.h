@@ -10,11 +10,68 @@
 
 /**
  * @brief Initialize the modem library and track its state.
- * 
+ *
+ * On failure the library is shut down again, so a later call starts afresh.
  * @return 0 on success, negative errno code on failure.
  */
 int power_mgr_modem_init(void);
 
+/**
+ * @brief Reset cause of the current boot (hwinfo RESET_* bits).
+ *
+ * Read and cleared on first call, then cached for the rest of the boot.
+ */
+uint32_t power_mgr_reset_cause(void);
+
+/**
+ * @brief Get the serving cell reported by the network after attach.
+ *
+ * @return 0 on success, -ENODATA if no cell update has been received.
+ */
+int power_mgr_get_cell(uint32_t *id, uint32_t *tac);
+
+/**
+ * @brief Primary DNS server the network assigned with the default PDN connection.
+ *
+ * @param buf Dotted-quad string, NUL terminated.
+ * @param len Size of @p buf (16 fits any IPv4 address).
+ *
+ * @return 0 on success, -ENODATA if the network did not assign one.
+ */
+int power_mgr_get_dns_server(char *buf, size_t len);
+
+/* Radio conditions after attach, from the modem's connection evaluation */
+struct radio_metrics {
+    int16_t rsrp;            // dBm
+    int16_t rsrq;            // dB
+    int16_t tx_power;        // Estimated TX power, dBm
+    uint8_t ce_level;        // Coverage enhancement level 0..3, UINT8_MAX if unknown
+    uint8_t energy_estimate; // enum lte_lc_energy_estimate (5 = excessive .. 9 = efficient)
+};
+
+/**
+ * @brief Evaluate current radio conditions.
+ *
+ * @return 0 on success, negative errno if the modem could not evaluate.
+ */
+int power_mgr_get_radio_metrics(struct radio_metrics *metrics);
+
+/**
+ * @brief Ask the network to let the modem enter PSM and wait for RRC release.
+ *
+ * Returns once the RRC connection is idle, or after 60 s.
+ *
+ * @return 0 if idle with PSM granted, -EAGAIN if idle without PSM,
+ *         -ETIMEDOUT if the connection was not released, other negative errno
+ *         if the request failed.
+ */
+int power_mgr_modem_park(void);
+
+/**
+ * @brief Detach and shut the modem down; power_mgr_modem_init() starts it again.
+ */
+void power_mgr_modem_off(void);
+
 /**
  * @brief Enter System OFF state (Deep Sleep)
  * 
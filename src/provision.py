@@ -0,0 +1,269 @@
+import argparse
+import csv
+import json
+import os
+import re
+import struct
+import sys
+import threading
+import time
+import uuid
+import zlib
+
+from udp_server import CONFIG_KEYS
+
+# Must match src/app/provision.h
+PROTO_VERSION = 1
+BUNDLE_VERSION = 1
+MAX_CFG = 8
+
+RESULTS = {
+    0: 'ok',
+    1: 'bad frame',
+    2: 'bad bundle',
+    3: 'bad signature',
+    4: 'wrong unit',
+    5: 'bad config',
+    6: 'store failed',
+    7: 'self-test failed',
+}
+TEST_BITS = {0x01: 'sensor', 0x02: 'pmic', 0x04: 'flash'}
+
+READY_RE = re.compile(r'#PV:READY (\d+) ([0-9a-f]{16})')
+RESULT_RE = re.compile(r'#PV:RESULT ([0-9a-f]{30})')
+
+
+def load_private_key(path):
+    from cryptography.hazmat.primitives import serialization
+    with open(path, 'rb') as f:
+        return serialization.load_pem_private_key(f.read(), password=None)
+
+
+def public_key_hex(key):
+    from cryptography.hazmat.primitives import serialization
+    return key.public_key().public_bytes(serialization.Encoding.X962,
+                                         serialization.PublicFormat.UncompressedPoint).hex()
+
+
+def keygen(args):
+    from cryptography.hazmat.primitives import serialization
+    from cryptography.hazmat.primitives.asymmetric import ec
+
+    if os.path.exists(args.out):
+        print(f"Error: {args.out} exists, not overwriting", file=sys.stderr)
+        return 1
+    key = ec.generate_private_key(ec.SECP256R1())
+    with open(args.out, 'wb') as f:
+        f.write(key.private_bytes(serialization.Encoding.PEM,
+                                  serialization.PrivateFormat.PKCS8,
+                                  serialization.NoEncryption()))
+    os.chmod(args.out, 0o600)
+    print(f'CONFIG_SEAL_PROVISION_PUBKEY="{public_key_hex(key)}"')
+    return 0
+
+
+def load_config_entries(path):
+    """
+    Config overrides as {"name": value}, using the names of udp_server.py plans.
+    """
+    if not path:
+        return []
+    with open(path) as f:
+        values = json.load(f)
+    values = values.get('values', values)
+    if len(values) > MAX_CFG:
+        raise ValueError(f"At most {MAX_CFG} config overrides fit in a bundle")
+    return [(CONFIG_KEYS[name], int(value)) for name, value in values.items()]
+
+
+def build_bundle(key, hw_id, device_id, server, device_key, cfg_entries):
+    from cryptography.hazmat.primitives import hashes
+    from cryptography.hazmat.primitives.asymmetric import ec
+    from cryptography.hazmat.primitives.asymmetric.utils import decode_dss_signature
+
+    host, port = server
+    body = struct.pack('<BB8s16s4sH32sB', BUNDLE_VERSION, 0, hw_id, device_id,
+                       bytes(int(o) for o in host.split('.')), port, device_key,
+                       len(cfg_entries))
+    for k, v in cfg_entries:
+        body += struct.pack('<BI', k, v)
+
+    r, s = decode_dss_signature(key.sign(body, ec.ECDSA(hashes.SHA256())))
+    return body + r.to_bytes(32, 'big') + s.to_bytes(32, 'big')
+
+
+def frame(bundle):
+    return b'PV' + struct.pack('<H', len(bundle)) + bundle + struct.pack('<I', zlib.crc32(bundle))
+
+
+def parse_report(hex_str):
+    raw = bytes.fromhex(hex_str)
+    _, result, failed = raw[:3]
+    verify, store, sensor, pmic, flash, total = struct.unpack('<6H', raw[3:15])
+    return {
+        'result': RESULTS.get(result, str(result)),
+        'failed': '+'.join(name for bit, name in TEST_BITS.items() if failed & bit),
+        'verify_ms': verify,
+        'store_ms': store,
+        'sensor_ms': sensor,
+        'pmic_ms': pmic,
+        'flash_ms': flash,
+        'device_ms': total,
+    }
+
+
+class Station:
+    """
+    Provisions units on one serial port, one after the other.
+    """
+
+    def __init__(self, port, args, key, cfg_entries, sink):
+        self.port = port
+        self.args = args
+        self.key = key
+        self.cfg_entries = cfg_entries
+        self.sink = sink
+        self.done = set()
+
+    def wait_line(self, ser, pattern, timeout):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            line = ser.readline().decode('ascii', errors='replace')
+            m = pattern.search(line)
+            if m:
+                return m
+        return None
+
+    def provision_one(self, ser):
+        m = self.wait_line(ser, READY_RE, self.args.wait)
+        if not m:
+            return False
+        hw_id = m.group(2)
+        if hw_id in self.done:
+            return True  # Stale announcement from a unit that is already done
+        start = time.monotonic()
+
+        device_id = uuid.uuid4().bytes
+        device_key = os.urandom(32)
+        bundle = build_bundle(self.key, bytes.fromhex(hw_id), device_id, self.args.server,
+                              device_key, self.cfg_entries)
+        ser.write(frame(bundle))
+
+        m = self.wait_line(ser, RESULT_RE, self.args.timeout)
+        report = parse_report(m.group(1)) if m else {'result': 'no report'}
+        report.update({
+            'port': self.port,
+            'hw_id': hw_id,
+            'device_id': device_id.hex(),
+            'host_ms': int((time.monotonic() - start) * 1000),
+        })
+        if report['result'] == 'ok':
+            self.done.add(hw_id)
+        self.sink(report, device_key)
+        return True
+
+    def run(self):
+        import serial
+
+        with serial.Serial(self.port, self.args.baud, timeout=0.1) as ser:
+            while True:
+                got_unit = self.provision_one(ser)
+                if not self.args.continuous:
+                    if not got_unit:
+                        print(f"[{self.port}] no unit announced itself")
+                    return
+
+
+class ResultSink:
+    """
+    Thread-safe CSV log of reports, plus the device keys for the ingest server.
+    """
+
+    FIELDS = ['port', 'hw_id', 'device_id', 'result', 'failed', 'verify_ms', 'store_ms',
+              'sensor_ms', 'pmic_ms', 'flash_ms', 'device_ms', 'host_ms']
+
+    def __init__(self, log_path, keys_path):
+        self.lock = threading.Lock()
+        new = not os.path.exists(log_path)
+        self.log = open(log_path, 'a', newline='')
+        self.writer = csv.DictWriter(self.log, fieldnames=self.FIELDS, extrasaction='ignore')
+        if new:
+            self.writer.writeheader()
+        self.keys = open(keys_path, 'a')
+        os.chmod(keys_path, 0o600)
+        self.count = 0
+        self.passed = 0
+
+    def __call__(self, report, device_key):
+        with self.lock:
+            self.count += 1
+            self.writer.writerow(report)
+            self.log.flush()
+            if report['result'] == 'ok':
+                self.passed += 1
+                self.keys.write(f"{report['device_id']},{device_key.hex()}\n")
+                self.keys.flush()
+            print(f"[{report['port']}] {report['hw_id']}: {report['result']}"
+                  f"{' (' + report['failed'] + ')' if report.get('failed') else ''}"
+                  f" in {report['host_ms']} ms")
+
+    def close(self):
+        self.log.close()
+        self.keys.close()
+
+
+def parse_server(text):
+    host, _, port = text.rpartition(':')
+    if len(host.split('.')) != 4:
+        raise argparse.ArgumentTypeError("expected IPv4:port")
+    return host, int(port)
+
+
+def run(args):
+    key = load_private_key(args.key)
+    cfg_entries = load_config_entries(args.config)
+    sink = ResultSink(args.log, args.keys_out)
+    start = time.monotonic()
+
+    threads = [threading.Thread(target=Station(p, args, key, cfg_entries, sink).run, daemon=True)
+               for p in args.ports]
+    for t in threads:
+        t.start()
+    try:
+        for t in threads:
+            t.join()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        elapsed = time.monotonic() - start
+        print(f"{sink.passed}/{sink.count} units passed in {elapsed:.1f} s "
+              f"({sink.count / elapsed * 3600:.0f} units/h over {len(args.ports)} port(s))")
+        sink.close()
+    return 0 if sink.passed == sink.count else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Security Seal factory provisioning station')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    kg = sub.add_parser('keygen', help='Create the factory signing key')
+    kg.add_argument('--out', default='factory_key.pem')
+
+    rn = sub.add_parser('run', help='Provision units on one or more serial ports in parallel')
+    rn.add_argument('ports', nargs='+', help='Serial ports, one unit per port')
+    rn.add_argument('--key', required=True, help='Factory signing key (PEM)')
+    rn.add_argument('--server', type=parse_server, required=True, help='Ingest server IPv4:port')
+    rn.add_argument('--config', help='JSON config overrides, e.g. {"tx_retries": 5}')
+    rn.add_argument('--baud', type=int, default=115200)
+    rn.add_argument('--wait', type=float, default=30.0, help='Seconds to wait for a unit to announce itself')
+    rn.add_argument('--timeout', type=float, default=5.0, help='Seconds to wait for the report')
+    rn.add_argument('--continuous', action='store_true', help='Keep provisioning the next unit on each port')
+    rn.add_argument('--log', default='provision_log.csv')
+    rn.add_argument('--keys-out', default='device_keys.csv', help='device_id,key for the ingest server')
+
+    args = parser.parse_args()
+    return keygen(args) if args.cmd == 'keygen' else run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
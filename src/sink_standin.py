@@ -0,0 +1,177 @@
+import argparse
+import json
+import random
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+from latency_hist import LatencyHistogram
+from udp_server import TLV_FW, TLV_LATENCY
+
+
+class Tally:
+    """
+    What the stand-in consumers received: unique events, duplicates from
+    redelivery, and receive-to-consume latency measured on the same host.
+    """
+
+    def __init__(self, name):
+        self.name = name
+        self.lock = threading.Lock()
+        self.seen = set()
+        self.duplicates = 0
+        self.batches = 0
+        self.latency_us = LatencyHistogram()
+
+    def consume(self, events):
+        now = time.time()
+        with self.lock:
+            self.batches += 1
+            for e in events:
+                if e['event_id'] in self.seen:
+                    self.duplicates += 1
+                    continue
+                self.seen.add(e['event_id'])
+                self.latency_us.record((now - e['received_at']) * 1e6)
+
+    def report(self):
+        with self.lock:
+            print(f"  {self.name}: events {len(self.seen)}, duplicates {self.duplicates}, batches {self.batches}")
+            print(f"    udp-receive-to-consume (us): {self.latency_us.summary()}")
+
+
+def make_http_handler(tally, args):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = 'HTTP/1.1'  # Keep-alive, like a real webhook endpoint
+
+        def do_POST(self):
+            body = self.rfile.read(int(self.headers.get('Content-Length', 0)))
+            time.sleep(args.delay_ms / 1000.0)
+            if random.random() < args.fail_rate:
+                self.send_response(503)
+                self.send_header('Content-Length', '0')
+                self.end_headers()
+                return
+            tally.consume(json.loads(body))
+            self.send_response(204)
+            self.end_headers()
+
+        def log_message(self, *a):
+            pass
+
+    return Handler
+
+
+def make_nats_handler(tally, args):
+    class Handler(socketserver.StreamRequestHandler):
+        """
+        Just enough of the NATS text protocol for NatsSink: INFO, CONNECT,
+        PUB and PING. A failure drops the connection mid-batch.
+        """
+
+        def handle(self):
+            self.wfile.write(b'INFO {"server_id":"standin","max_payload":1048576}\r\n')
+            pending = []
+            while True:
+                line = self.rfile.readline()
+                if not line:
+                    return
+                op = line.split(b' ', 1)[0].strip().upper()
+                if op == b'PUB':
+                    size = int(line.split()[-1])
+                    pending.append(json.loads(self.rfile.read(size + 2)[:size]))
+                elif op == b'PING':
+                    time.sleep(args.delay_ms / 1000.0)
+                    if random.random() < args.fail_rate:
+                        return
+                    tally.consume(pending)
+                    pending = []
+                    self.wfile.write(b'PONG\r\n')
+
+    return Handler
+
+
+def serve(args):
+    tallies = []
+    servers = []
+    if args.http_port:
+        tallies.append(Tally('webhook'))
+        servers.append(ThreadingHTTPServer(('127.0.0.1', args.http_port), make_http_handler(tallies[-1], args)))
+        print(f"Webhook stand-in on http://127.0.0.1:{args.http_port}/")
+    if args.nats_port:
+        tallies.append(Tally('nats'))
+        socketserver.ThreadingTCPServer.allow_reuse_address = True
+        servers.append(socketserver.ThreadingTCPServer(('127.0.0.1', args.nats_port),
+                                                       make_nats_handler(tallies[-1], args)))
+        print(f"NATS stand-in on nats://127.0.0.1:{args.nats_port}/seal.alerts")
+    for s in servers:
+        threading.Thread(target=s.serve_forever, daemon=True).start()
+
+    try:
+        while True:
+            time.sleep(args.report_interval)
+            for t in tallies:
+                t.report()
+    except KeyboardInterrupt:
+        for t in tallies:
+            t.report()
+    finally:
+        for s in servers:
+            s.shutdown()
+    return 0
+
+
+def alert_packet(device_id):
+    since = random.randint(2000, 9000)
+    latency = struct.pack('<IIIIBB', since, 300, since - 800, 400, 1, 0)
+    return (device_id + b'\x01' +
+            bytes([TLV_FW, 2, 1, 0]) +
+            bytes([TLV_LATENCY, len(latency)]) + latency)
+
+
+def burst(args):
+    host, _, port = args.target.rpartition(':')
+    devices = [uuid.uuid4().bytes for _ in range(args.devices)]
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    gap = 1.0 / args.rate if args.rate else 0
+    start = time.monotonic()
+    for i in range(args.count):
+        sock.sendto(alert_packet(devices[i % len(devices)]), (host, int(port)))
+        if gap:
+            # Pace against the start time so sleep jitter does not accumulate
+            delay = start + (i + 1) * gap - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+    elapsed = time.monotonic() - start
+    print(f"Sent {args.count} alerts from {len(devices)} devices in {elapsed:.2f} s")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Local stand-ins for alert fan-out sinks')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    sv = sub.add_parser('serve', help='Run webhook and NATS consumers that count what they get')
+    sv.add_argument('--http-port', type=int, default=8081)
+    sv.add_argument('--nats-port', type=int, default=4222)
+    sv.add_argument('--delay-ms', type=float, default=0, help='Per-batch processing delay (slow consumer)')
+    sv.add_argument('--fail-rate', type=float, default=0, help='Fraction of batches to reject')
+    sv.add_argument('--report-interval', type=float, default=10)
+
+    bu = sub.add_parser('burst', help='Send a burst of synthetic seal openings to the UDP server')
+    bu.add_argument('--target', default='127.0.0.1:5000', help='UDP server host:port')
+    bu.add_argument('--count', type=int, default=5000)
+    bu.add_argument('--devices', type=int, default=1000)
+    bu.add_argument('--rate', type=float, default=0, help='Packets per second, 0 for as fast as possible')
+
+    args = parser.parse_args()
+    return serve(args) if args.cmd == 'serve' else burst(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
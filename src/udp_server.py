@@ -1,14 +1,306 @@
 import socket
 import argparse
+import hashlib
+import hmac
+import os
+import struct
 import sys
+import time
+import uuid
 
-def run_udp_server(host, port):
+from latency_hist import LatencyHistogram, KeyedHistograms
+from alert_fanout import AlertFanout
+
+# Optional TLV records after the fixed 17-byte header: [type][len][value]
+TLV_LOG = 0x10
+TLV_LATENCY = 0x11
+TLV_FW = 0x12
+TLV_CELL = 0x13
+TLV_CONFIG = 0x14
+TLV_RADIO = 0x15
+TLV_STALL = 0x16
+TLV_EVENT = 0x17
+
+# Reply datagram: 'A', version, config seq u16, count, count x (key u8, value u32).
+# A delta ends in a 16-byte HMAC-SHA256 tag (device key) over the reply plus the alert seq u32.
+ACK_MAGIC = 0x41
+ACK_VERSION = 2
+ACK_TAG_SIZE = 16
+CONFIG_KEYS = {
+    'target_dark_seconds': 1,
+    'dark_threshold': 2,
+    'int_threshold': 3,
+    'tx_retries': 4,
+    'sock_timeout_s': 5,
+    'retry_delay_s': 6,
+    'wdt_timeout_ms': 7,
+}
+
+LATENCY_FLAG_WARM = 0x01
+LATENCY_FLAG_RESUMED = 0x02
+LATENCY_FLAG_DNS = 0x04
+
+STALL_REASONS = {1: 'watchdog reset', 2: 'deadline overrun'}
+STALL_STAGES = {0: 'idle', 1: 'sensor', 2: 'storage', 3: 'attach', 4: 'radio_eval', 5: 'send', 6: 'dns'}
+
+STRATEGY_NAMES = {0: 'send_now', 1: 'defer', 2: 'minimal'}
+CE_UNKNOWN = 0xFF
+
+
+class LatencyStats:
+    """
+    Streaming trigger-to-receipt latency per device, firmware version and cell.
+    """
+
+    def __init__(self, max_keys=1024):
+        self.by_device = KeyedHistograms(max_keys)
+        self.by_fw = KeyedHistograms(max_keys)
+        self.by_cell = KeyedHistograms(max_keys)
+        self.stages = {name: LatencyHistogram() for name in ('boot', 'attach', 'send')}
+        # Send stage with and without a DNS lookup on the alert path
+        self.send_by_path = {name: LatencyHistogram() for name in ('cached', 'dns')}
+        self.resumed = 0
+
+    def record(self, dev_id, fw, cell, lat):
+        # Alerts resumed after a reboot only carry a lower bound; keep them out of the SLO
+        if lat['flags'] & LATENCY_FLAG_RESUMED:
+            self.resumed += 1
+            return
+        e2e = lat['since_trigger_ms']
+        self.by_device.record(dev_id, e2e)
+        self.by_fw.record(fw, e2e)
+        self.by_cell.record(cell, e2e)
+        self.stages['boot'].record(lat['boot_ms'])
+        self.stages['attach'].record(lat['attach_ms'])
+        self.stages['send'].record(lat['send_ms'])
+        self.send_by_path['dns' if lat['flags'] & LATENCY_FLAG_DNS else 'cached'].record(lat['send_ms'])
+
+    def report(self):
+        print("\n=== Trigger-to-receipt latency (ms) ===")
+        for title, keyed in (("firmware", self.by_fw), ("cell", self.by_cell), ("device", self.by_device)):
+            print(f"  per {title}:")
+            for key, hist in keyed.items():
+                print(f"    {key}: {hist.summary()}")
+        print("  stages:")
+        for name, hist in self.stages.items():
+            print(f"    {name}: {hist.summary()}")
+        print("  send by endpoint path:")
+        for name, hist in self.send_by_path.items():
+            print(f"    {name}: {hist.summary()}")
+        print(f"  resumed (excluded): {self.resumed}")
+
+
+class CoverageStats:
+    """
+    Radio-on cost of delivered alerts per coverage enhancement (CE) level.
+    Attach plus send time and attempt count stand in for energy, which the
+    modem does not report directly.
+    """
+
+    def __init__(self):
+        self.radio_ms = {}
+        self.attempts = {}
+        self.strategies = {}
+
+    def record(self, radio, lat):
+        ce = 'unknown' if radio['ce_level'] == CE_UNKNOWN else f"CE{radio['ce_level']}"
+        counts = self.strategies.setdefault(ce, {})
+        counts[radio['strategy']] = counts.get(radio['strategy'], 0) + 1
+        if lat and not lat['flags'] & LATENCY_FLAG_RESUMED:
+            self.radio_ms.setdefault(ce, LatencyHistogram()).record(lat['attach_ms'] + lat['send_ms'])
+            self.attempts.setdefault(ce, LatencyHistogram()).record(lat['attempts'])
+
+    def report(self):
+        print("\n=== Delivered alerts by coverage class ===")
+        for ce in sorted(self.strategies):
+            counts = ", ".join(f"{k} {v}" for k, v in sorted(self.strategies[ce].items()))
+            print(f"  {ce}: {counts}")
+            if ce in self.radio_ms:
+                print(f"    attach+send ms: {self.radio_ms[ce].summary()}")
+                print(f"    attempts: {self.attempts[ce].summary(percentiles=(50, 99))}")
+
+
+def parse_radio(value):
+    strategy, defers, rsrp, rsrq, tx_power, ce_level, energy = struct.unpack('<BBhhhBB', value[:10])
+    return {
+        'strategy': STRATEGY_NAMES.get(strategy, f"0x{strategy:02X}"),
+        'defers': defers,
+        'rsrp': rsrp,
+        'rsrq': rsrq,
+        'tx_power': tx_power,
+        'ce_level': ce_level,
+        'energy': energy,
+    }
+
+
+def parse_stall(value):
+    (reason, state, stage, overruns, uptime, elapsed, since_kick,
+     pc, lr, stack_main, stack_wq) = struct.unpack('<BBBBIIIIIHH', value[:28])
+    return (f"{STALL_REASONS.get(reason, reason)} in state {state}, "
+            f"stage {STALL_STAGES.get(stage, stage)} for {elapsed} ms "
+            f"(uptime {uptime} ms, last kick {since_kick} ms before), "
+            f"pc 0x{pc:08X} lr 0x{lr:08X}, stack unused main {stack_main} B / "
+            f"workq {stack_wq} B, {overruns} overrun(s)")
+
+
+def load_config_plan(path):
+    """
+    Loads the desired fleet config: {"seq": N, "values": {...},
+    "devices": {"<device id hex>": {"seq": N, "values": {...}}}}.
+    """
+    import json
+    with open(path) as f:
+        plan = json.load(f)
+    for entry in [plan] + list(plan.get('devices', {}).values()):
+        for name in entry.get('values', {}):
+            if name not in CONFIG_KEYS:
+                raise ValueError(f"Unknown config key '{name}'")
+    return plan
+
+
+def load_device_keys(path):
+    """
+    Loads the device_id,key hex lines written by provision.py --keys-out.
+    """
+    keys = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                dev_id, key = line.split(',')
+                keys[dev_id] = bytes.fromhex(key)
+    return keys
+
+
+def plan_entry(plan, dev_id_str):
+    """
+    Target (seq, values) for one device: its own entry on top of the fleet values.
+    """
+    if not plan:
+        return None
+    device = plan.get('devices', {}).get(dev_id_str)
+    if device is not None:
+        return device['seq'], {**plan.get('values', {}), **device.get('values', {})}
+    if 'seq' in plan:
+        return plan['seq'], plan.get('values', {})
+    return None
+
+
+class ConfigTracker:
+    """
+    Remembers per device which config seqs it refused, so a delta that fails
+    its trial (rolled back) or keeps being ignored (rejected by the range
+    checks) is not offered again until the plan moves to a new seq.
+    """
+
+    # Offers without the device ever running the seq before it counts as rejected;
+    # more than one, since an acknowledgement can be lost
+    MAX_OFFERS = 3
+
+    def __init__(self):
+        self.devices = {}
+
+    def should_offer(self, dev_id_str, target_seq, device_seq):
+        state = self.devices.setdefault(dev_id_str, {'seq': None, 'offers': 0, 'tried': False,
+                                                     'rejected': set()})
+        if state['seq'] != target_seq:
+            state.update(seq=target_seq, offers=0, tried=False)
+        if target_seq in state['rejected']:
+            return False
+        if device_seq == target_seq:
+            state['tried'] = True
+            return False
+        # Ran it as a trial and is back on another seq: it was rolled back
+        if state['tried'] or state['offers'] >= self.MAX_OFFERS:
+            state['rejected'].add(target_seq)
+            print(f"  Config seq {target_seq} refused by {dev_id_str}, no longer offered")
+            return False
+        state['offers'] += 1
+        return True
+
+
+def build_reply(plan, dev_id_str, device_seq, tracker=None, key=None, event_seq=None):
+    """
+    Builds the acknowledgement, carrying a config delta if the device is behind.
+    A delta needs the device key and the alert seq it answers; without them
+    the device would refuse it, so only a plain acknowledgement is sent.
+    """
+    target = plan_entry(plan, dev_id_str)
+    offer = target is not None and device_seq is not None
+    if offer and (key is None or event_seq is None):
+        print(f"  No device key or alert seq for {dev_id_str}, config not offered")
+        offer = False
+    if offer and tracker is not None:
+        offer = tracker.should_offer(dev_id_str, target[0], device_seq)
+    elif offer:
+        offer = device_seq != target[0]
+    if not offer:
+        seq = device_seq if device_seq is not None else 0
+        return struct.pack('<BBHB', ACK_MAGIC, ACK_VERSION, seq, 0)
+
+    seq, values = target
+    reply = struct.pack('<BBHB', ACK_MAGIC, ACK_VERSION, seq, len(values))
+    for name, value in values.items():
+        reply += struct.pack('<BI', CONFIG_KEYS[name], int(value))
+    tag = hmac.new(key, reply + struct.pack('<I', event_seq), hashlib.sha256).digest()
+    return reply + tag[:ACK_TAG_SIZE]
+
+
+def parse_latency(value):
+    since, boot, attach, send, attempts, flags = struct.unpack('<IIIIBB', value[:18])
+    return {
+        'since_trigger_ms': since,
+        'boot_ms': boot,
+        'attach_ms': attach,
+        'send_ms': send,
+        'attempts': attempts,
+        'flags': flags,
+    }
+
+
+def parse_tlvs(data):
+    """
+    Splits the TLV trailer into a list of (type, value) tuples.
+    """
+    tlvs = []
+    i = 0
+    while i + 2 <= len(data):
+        t, l = data[i], data[i + 1]
+        if i + 2 + l > len(data):
+            raise ValueError(f"Truncated TLV 0x{t:02X} at offset {i}")
+        tlvs.append((t, data[i + 2:i + 2 + l]))
+        i += 2 + l
+    return tlvs
+
+
+def save_log_tlv(log_dir, dev_id_str, value):
+    """
+    Stores an attached log tail for decoding with log_decode.py --uplink.
+    """
+    os.makedirs(log_dir, exist_ok=True)
+    path = os.path.join(log_dir, f"{dev_id_str}_{int(time.time())}.lrz")
+    with open(path, 'wb') as f:
+        f.write(value)
+    return path
+
+
+def run_udp_server(host, port, log_dir='device_logs', stats_interval=60, config_plan=None,
+                   fanout=None, quiet=False, device_keys=None):
     """
     Runs a simple UDP server to print incoming packets.
     """
+    stats = LatencyStats()
+    coverage = CoverageStats()
+    config_tracker = ConfigTracker()
+    fanout = fanout or AlertFanout([])
+    # Per-packet console output is the slowest part of a burst; --quiet keeps only the reports
+    log = (lambda *a, **k: None) if quiet else print
+    sock = None
     try:
         # Create a UDP socket
         sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        # Room for a burst of alerts while the loop is busy
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 * 1024 * 1024)
         
         # Bind the socket to the address and port
         server_address = (host, port)
@@ -22,43 +314,141 @@ def run_udp_server(host, port):
             print(f"Error binding to {host}:{port}: {e}")
             return
 
+        next_report = time.monotonic() + stats_interval
+
         while True:
-            print("\nWaiting to receive message...")
+            log("\nWaiting to receive message...")
             data, address = sock.recvfrom(4096)
+            recv_time = time.time()
             
-            print(f"Received {len(data)} bytes from {address}")
+            log(f"Received {len(data)} bytes from {address} at {recv_time:.3f}")
             
             # Parse 'seal_payload_t': <16s (ID) B (Status)
             # Size: 16 + 1 = 17 bytes
             try:
-                import struct
-                if len(data) == 17:
-                    device_id, status = struct.unpack('<16sB', data)
+                if len(data) >= 17:
+                    device_id, status = struct.unpack('<16sB', data[:17])
                     
                     # Clean up Device ID (bytes to hex or string)
                     dev_id_str = device_id.hex()
                     
-                    print(f"  [Parsed Payload]")
-                    print(f"  Device ID  : {dev_id_str}")
-                    print(f"  Status Code: 0x{status:02X} ({'OPENED' if status == 0x01 else 'UNKNOWN'})")
+                    log(f"  [Parsed Payload]")
+                    log(f"  Device ID  : {dev_id_str}")
+                    log(f"  Status Code: 0x{status:02X} ({'OPENED' if status == 0x01 else 'UNKNOWN'})")
+
+                    fw = 'unknown'
+                    cell = 'unknown'
+                    lat = None
+                    radio = None
+                    device_seq = None
+                    event_seq = None
+                    for t, value in parse_tlvs(data[17:]):
+                        if t == TLV_LOG:
+                            path = save_log_tlv(log_dir, dev_id_str, value)
+                            log(f"  Log Tail   : {len(value)} bytes -> {path}")
+                        elif t == TLV_LATENCY:
+                            lat = parse_latency(value)
+                        elif t == TLV_FW:
+                            fw = f"{value[0]}.{value[1]}"
+                        elif t == TLV_CELL:
+                            cell_id, tac = struct.unpack('<IH', value[:6])
+                            cell = f"{tac:04X}/{cell_id:08X}"
+                        elif t == TLV_CONFIG:
+                            device_seq, trial = struct.unpack('<HB', value[:3])
+                            log(f"  Config     : seq {device_seq}{' (trial)' if trial else ''}")
+                        elif t == TLV_STALL:
+                            log(f"  Stall      : {parse_stall(value)}")
+                        elif t == TLV_RADIO:
+                            radio = parse_radio(value)
+                        elif t == TLV_EVENT:
+                            event_seq, = struct.unpack('<I', value[:4])
+                            log(f"  Alert Seq  : {event_seq}")
+                        else:
+                            log(f"  TLV 0x{t:02X}   : {value.hex()}")
+
+                    log(f"  Firmware   : {fw}")
+                    log(f"  Cell       : {cell}")
+                    if lat:
+                        trigger_time = recv_time - lat['since_trigger_ms'] / 1000.0
+                        log(f"  Latency    : {lat['since_trigger_ms']} ms since trigger "
+                            f"(boot {lat['boot_ms']}, attach {lat['attach_ms']}, "
+                            f"send {lat['send_ms']}, attempts {lat['attempts']}, "
+                            f"{'warm' if lat['flags'] & LATENCY_FLAG_WARM else 'cold'}"
+                            f"{', resumed' if lat['flags'] & LATENCY_FLAG_RESUMED else ''}"
+                            f"{', dns' if lat['flags'] & LATENCY_FLAG_DNS else ''})")
+                        log(f"  Triggered  : ~{trigger_time:.3f}")
+                        stats.record(dev_id_str, fw, cell, lat)
+                    if radio:
+                        ce = 'unknown' if radio['ce_level'] == CE_UNKNOWN else radio['ce_level']
+                        log(f"  Radio      : {radio['strategy']} after {radio['defers']} defer(s), "
+                            f"CE {ce}, RSRP {radio['rsrp']} dBm, RSRQ {radio['rsrq']} dB, "
+                            f"TX {radio['tx_power']} dBm, energy {radio['energy']}")
+                        coverage.record(radio, lat)
+
+                    # Reply while the device's RRC connection is still up
+                    reply = build_reply(config_plan, dev_id_str, device_seq, config_tracker,
+                                        (device_keys or {}).get(dev_id_str), event_seq)
+                    sock.sendto(reply, address)
+                    if reply[4]:
+                        log(f"  Reply      : config seq {struct.unpack('<H', reply[2:4])[0]}, {reply[4]} value(s)")
+
+                    fanout.publish({
+                        # Retransmissions of one opening share the id; older firmware has no sequence
+                        'event_id': f"{dev_id_str}-{event_seq}" if event_seq is not None
+                                    else uuid.uuid4().hex,
+                        'device_id': dev_id_str,
+                        'status': 'opened' if status == 0x01 else f"0x{status:02X}",
+                        'received_at': recv_time,
+                        'trigger_at': trigger_time if lat else None,
+                        'firmware': fw,
+                        'cell': cell,
+                        'config_seq': device_seq,
+                        'latency': lat,
+                        'radio': radio,
+                    })
                 else:
-                     print(f"  [Raw Data]: {data.hex()} (Length mismatch, expected 17)")
+                     log(f"  [Raw Data]: {data.hex()} (Length mismatch, expected >= 17)")
 
             except Exception as e:
                 print(f"  Parsing Error: {e}")
                 print(f"  Raw Data: {data.hex()}")
 
+            if time.monotonic() >= next_report:
+                stats.report()
+                coverage.report()
+                fanout.report()
+                next_report = time.monotonic() + stats_interval
+
     except KeyboardInterrupt:
         print("\nServer stopping...")
+        stats.report()
+        coverage.report()
+        fanout.report()
     except Exception as e:
         print(f"\nUnexpected error: {e}")
     finally:
-        sock.close()
+        # Undelivered alerts stay in the journal for the next run
+        fanout.close()
+        if sock is not None:
+            sock.close()
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description='Simple UDP Server for IoT Testing')
     parser.add_argument('--host', default='0.0.0.0', help='Host to bind to (default: 0.0.0.0)')
     parser.add_argument('--port', type=int, default=5000, help='Port to bind to (default: 5000)')
+    parser.add_argument('--log-dir', default='device_logs', help='Where attached device logs are stored')
+    parser.add_argument('--stats-interval', type=int, default=60, help='Seconds between latency reports (default: 60)')
+    parser.add_argument('--config', help='JSON config plan to push to devices in acknowledgements')
+    parser.add_argument('--keys', default='device_keys.csv',
+                        help='Device keys from provision.py, needed to sign config deltas')
+    parser.add_argument('--sink', action='append', default=[],
+                        help='Forward alerts to file:<path>, http(s)://<url> or nats://host:port/subject (repeatable)')
+    parser.add_argument('--journal-dir', default='fanout_journal', help='Overflow journal for undelivered alerts')
+    parser.add_argument('--quiet', action='store_true', help='Only print periodic reports, not every packet')
     
     args = parser.parse_args()
-    run_udp_server(args.host, args.port)
+    plan = load_config_plan(args.config) if args.config else None
+    keys = load_device_keys(args.keys) if plan and os.path.exists(args.keys) else {}
+    fanout = AlertFanout(args.sink, args.journal_dir)
+    run_udp_server(args.host, args.port, args.log_dir, args.stats_interval, plan, fanout, args.quiet,
+                   keys)